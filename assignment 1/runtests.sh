@@ -15,3 +15,9 @@ for file in $2/boolean/* $2/combined/* $2/fixpoints_only/* $2/modal_operators/*;
         $1 --algo=naive testcases/fixpoints_only/test.aut $file
     fi
 done
+
+for file in $2/binders/*; do
+    if [ ${file: -4} == ".mcf" ]; then
+        $1 --algo=improved testcases/binders/test.aut $file
+    fi
+done
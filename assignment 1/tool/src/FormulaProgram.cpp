@@ -0,0 +1,301 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FormulaProgram.h"
+
+FormulaProgram::FormulaProgram(LabelledTransitionSystem& system, MuFormula& formula, bool naive) :
+    m_system(system),
+    m_naive(naive),
+    m_iterations(0),
+    m_scratch(system.getNumStates())
+{
+    if (!m_naive) {
+        collectInitialValues(&formula);
+    }
+
+    std::vector<Instruction> main;
+    m_result = compile(&formula, main);
+
+    // The closed subformulas are computed before the rest of the formula.
+    m_program.swap(m_prologue);
+    m_program.insert(m_program.end(), main.begin(), main.end());
+
+    m_initialFill.resize(m_slots.size(), false);
+    m_variables.assign(m_slots.size(), StateSet(system.getNumStates()));
+    m_registers.assign(m_permanent.size(), StateSet(system.getNumStates()));
+}
+
+const StateSet& FormulaProgram::solve()
+{
+    m_iterations = 0;
+    for (size_t slot = 0; slot < m_variables.size(); ++slot) {
+        if (m_initialFill[slot]) {
+            m_variables[slot].fill();
+        }
+        else {
+            m_variables[slot].clear();
+        }
+    }
+
+    for (size_t pc = 0; pc < m_program.size(); ++pc) {
+        const Instruction& instruction = m_program[pc];
+        if (instruction.opcode == ENTER_FIXPOINT) {
+            for (int reset = instruction.first; reset < instruction.second; ++reset) {
+                if (m_resets[reset].fill) {
+                    m_variables[m_resets[reset].slot].fill();
+                }
+                else {
+                    m_variables[m_resets[reset].slot].clear();
+                }
+            }
+            continue;
+        }
+
+        StateSet& target = m_registers[instruction.target];
+        switch (instruction.opcode) {
+        case CLEAR:
+            target.clear();
+            break;
+        case FILL:
+            target.fill();
+            break;
+        case LOAD:
+            target = m_variables[instruction.first];
+            break;
+        case INTERSECT:
+            target = m_registers[instruction.first];
+            target &= m_registers[instruction.second];
+            break;
+        case UNITE:
+            target = m_registers[instruction.first];
+            target |= m_registers[instruction.second];
+            break;
+        case SOME_SUCCESSOR:
+            target.clear();
+            for (int toState : m_registers[instruction.first]) {
+                for (int fromState : m_system.getFromStates(toState, instruction.label)) {
+                    target.insert(fromState);
+                }
+            }
+            break;
+        case ALL_SUCCESSORS:
+            target.fill();
+            m_scratch = m_registers[instruction.first];
+            m_scratch.complement();
+            for (int toState : m_scratch) {
+                for (int fromState : m_system.getFromStates(toState, instruction.label)) {
+                    target.erase(fromState);
+                }
+            }
+            break;
+        case ENTER_FIXPOINT:
+            break;
+        case LEAVE_FIXPOINT: {
+            ++m_iterations;
+            StateSet& approximation = m_variables[instruction.first];
+            if (approximation == m_registers[instruction.second]) {
+                target = approximation;
+            }
+            else {
+                // Continue with the first instruction of the body.
+                approximation = m_registers[instruction.second];
+                pc -= instruction.jump + 1;
+            }
+            break;
+        }
+        }
+    }
+
+    return m_registers[m_result];
+}
+
+int FormulaProgram::compile(MuFormula* formula, std::vector<Instruction>& code)
+{
+    if (formula->isOpen()) {
+        return compileOperation(formula, code, false);
+    }
+
+    // A closed subformula has the same result everywhere, so it is computed once up front.
+    auto closed = m_closedRegisters.find(formula);
+    if (closed != m_closedRegisters.end()) {
+        return closed->second;
+    }
+
+    std::vector<Instruction> block;
+    int result = compileOperation(formula, block, true);
+    m_prologue.insert(m_prologue.end(), block.begin(), block.end());
+    m_closedRegisters[formula] = result;
+    return result;
+}
+
+int FormulaProgram::compileOperation(MuFormula* formula, std::vector<Instruction>& code, bool permanent)
+{
+    Instruction instruction = { CLEAR, -1, -1, -1, -1, 0 };
+    std::vector<int> operands;
+
+    switch (formula->getOperation()) {
+    case FALSE:
+        instruction.opcode = CLEAR;
+        break;
+    case TRUE:
+        instruction.opcode = FILL;
+        break;
+    case VAR:
+        instruction.opcode = LOAD;
+        instruction.first = getSlot(formula->getVarLabel());
+        break;
+    case AND:
+    case OR:
+        instruction.opcode = (formula->getOperation() == AND) ? INTERSECT : UNITE;
+        instruction.first = compile(formula->getSubformula(), code);
+        instruction.second = compile(formula->getSubformula2(), code);
+        operands.push_back(instruction.first);
+        operands.push_back(instruction.second);
+        break;
+    case DIAMOND:
+    case BOX:
+        // The subformula is still evaluated, since it may update approximations.
+        instruction.first = compile(formula->getSubformula(), code);
+        operands.push_back(instruction.first);
+        instruction.label = m_system.getLabelIndex(formula->getVarLabel());
+        if (formula->getOperation() == DIAMOND) {
+            instruction.opcode = (instruction.label < 0) ? CLEAR : SOME_SUCCESSOR;
+        }
+        else {
+            instruction.opcode = (instruction.label < 0) ? FILL : ALL_SUCCESSORS;
+        }
+        break;
+    case MU:
+    case NU: {
+        int slot = getSlot(formula->getVarLabel());
+        std::map<int, bool> resets;
+
+        if (m_naive) {
+            resets[slot] = (formula->getOperation() == NU);
+        }
+        else if (formula->getPrevFixedPoint() == 'm' && formula->getOperation() == NU) {
+            collectResets(formula->getSubformula(), 'm', NU, resets);
+        }
+        else if (formula->getPrevFixedPoint() == 'n') {
+            collectResets(formula->getSubformula(), 'n', formula->getOperation(), resets);
+        }
+
+        Instruction enter = { ENTER_FIXPOINT, -1, int(m_resets.size()), -1, -1, 0 };
+        for (auto& reset : resets) {
+            Reset entry = { reset.first, reset.second };
+            m_resets.push_back(entry);
+        }
+        enter.second = int(m_resets.size());
+        code.push_back(enter);
+
+        size_t bodyStart = code.size();
+        instruction.opcode = LEAVE_FIXPOINT;
+        instruction.first = slot;
+        instruction.second = compile(formula->getSubformula(), code);
+        operands.push_back(instruction.second);
+        instruction.jump = int(code.size() - bodyStart);
+        break;
+    }
+    }
+
+    instruction.target = allocateRegister(permanent);
+    code.push_back(instruction);
+
+    // The results of the subformulas are no longer needed.
+    for (int operand : operands) {
+        releaseRegister(operand);
+    }
+
+    return instruction.target;
+}
+
+void FormulaProgram::collectResets(MuFormula* formula, char surroundingBinder, Op originalFixpoint, std::map<int, bool>& resets)
+{
+    Op operation = formula->getOperation();
+
+    if (formula->isOpen() && (operation == MU || operation == NU)) {
+        if (operation == originalFixpoint) {
+            resets[getSlot(formula->getVarLabel())] = (surroundingBinder == 'm');
+        }
+        collectResets(formula->getSubformula(), surroundingBinder, originalFixpoint, resets);
+        return;
+    }
+
+    switch (operation) {
+    case FALSE:
+    case TRUE:
+    case VAR:
+        break;
+    case AND:
+    case OR:
+        collectResets(formula->getSubformula(), formula->getPrevFixedPoint(), operation, resets);
+        collectResets(formula->getSubformula2(), formula->getPrevFixedPoint(), operation, resets);
+        break;
+    case BOX:
+    case DIAMOND:
+    case MU:
+    case NU:
+        collectResets(formula->getSubformula(), formula->getPrevFixedPoint(), operation, resets);
+        break;
+    }
+}
+
+void FormulaProgram::collectInitialValues(MuFormula* formula)
+{
+    Op operation = formula->getOperation();
+    if (operation == MU || operation == NU) {
+        int slot = getSlot(formula->getVarLabel());
+        m_initialFill.resize(m_slots.size(), false);
+        m_initialFill[slot] = (operation == NU);
+    }
+
+    if (operation == MU || operation == NU || operation == BOX || operation == DIAMOND) {
+        collectInitialValues(formula->getSubformula());
+    }
+    else if (operation == AND || operation == OR) {
+        collectInitialValues(formula->getSubformula());
+        collectInitialValues(formula->getSubformula2());
+    }
+}
+
+int FormulaProgram::getSlot(const std::string& name)
+{
+    auto slot = m_slots.find(name);
+    if (slot == m_slots.end()) {
+        slot = m_slots.insert(std::make_pair(name, int(m_slots.size()))).first;
+    }
+    return slot->second;
+}
+
+int FormulaProgram::allocateRegister(bool permanent)
+{
+    // Permanent registers are never reused, since the instructions using them may come earlier.
+    if (!permanent && !m_freeRegisters.empty()) {
+        int index = m_freeRegisters.back();
+        m_freeRegisters.pop_back();
+        return index;
+    }
+
+    m_permanent.push_back(permanent);
+    return int(m_permanent.size() - 1);
+}
+
+void FormulaProgram::releaseRegister(int index)
+{
+    if (index >= 0 && !m_permanent[index]) {
+        m_freeRegisters.push_back(index);
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_FORMULAPROGRAM_H_
+#define TOOL_FORMULAPROGRAM_H_
+
+#include "LabelledTransitionSystem.h"
+#include "MuCalculus.h"
+#include "StateSet.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A mu-calculus formula compiled for a labelled transition system into a flat list of
+ * instructions over preallocated state set registers.
+ *
+ * Fixpoint variables are resolved to slots by name and transition labels to label indices, so
+ * evaluating the program performs no lookups or allocations. A fixpoint becomes a loop that
+ * jumps back to the start of its body until the approximation is stable. Closed subformulas are
+ * hoisted in front of the program and computed once.
+ *
+ * The program evaluates the formula either naively or as Emerson-Lei, in which case entering a
+ * fixpoint only resets the approximations of the open fixpoints of the same kind nested in it,
+ * which are determined while compiling.
+ */
+class FormulaProgram
+{
+public:
+    FormulaProgram(LabelledTransitionSystem& system, MuFormula& formula, bool naive);
+
+    /**
+     * Returns the set of states in which the formula holds.
+     */
+    const StateSet& solve();
+
+    /**
+     * Returns the number of times a fixpoint body was evaluated by the last solve.
+     */
+    size_t getIterations() const { return m_iterations; }
+
+private:
+    enum Opcode {
+        CLEAR,          // target := {}
+        FILL,           // target := all states
+        LOAD,           // target := variable first
+        INTERSECT,      // target := first & second
+        UNITE,          // target := first | second
+        SOME_SUCCESSOR, // target := states with a label successor in first
+        ALL_SUCCESSORS, // target := states with all label successors in first
+        ENTER_FIXPOINT, // apply the resets from first up to second
+        LEAVE_FIXPOINT  // if variable first differs from second, assign it and jump back, else target := first
+    };
+
+    struct Instruction
+    {
+        Opcode opcode;
+        int target;
+        int first;
+        int second;
+        int label;
+        int jump;
+    };
+
+    /**
+     * Assigns all states to, or clears, the variable in the given slot.
+     */
+    struct Reset
+    {
+        int slot;
+        bool fill;
+    };
+
+    /**
+     * Appends the instructions computing formula to code and returns the register of the result.
+     * Closed subformulas are compiled into the prologue instead.
+     */
+    int compile(MuFormula* formula, std::vector<Instruction>& code);
+
+    /**
+     * Appends the instructions computing the operation of formula to code, storing the result in
+     * a permanent register or a temporary one.
+     */
+    int compileOperation(MuFormula* formula, std::vector<Instruction>& code, bool permanent);
+
+    /**
+     * Adds a reset to resets for every open fixpoint in formula of type originalFixpoint, filling its
+     * variable if surroundingBinder is 'm' and clearing it otherwise. The last reset of a slot wins.
+     */
+    void collectResets(MuFormula* formula, char surroundingBinder, Op originalFixpoint, std::map<int, bool>& resets);
+
+    /**
+     * Sets the initial approximation of the variables bound in formula, all states for a greatest
+     * fixpoint and no states for a least fixpoint.
+     */
+    void collectInitialValues(MuFormula* formula);
+
+    /**
+     * Returns the slot of the variable with the given name.
+     */
+    int getSlot(const std::string& name);
+
+    int allocateRegister(bool permanent);
+    void releaseRegister(int index);
+
+    LabelledTransitionSystem& m_system;
+    bool m_naive;
+    size_t m_iterations;
+
+    std::vector<Instruction> m_program;
+    std::vector<Instruction> m_prologue;
+    std::vector<Reset> m_resets;
+    int m_result;
+
+    std::map<std::string, int> m_slots;
+    std::vector<bool> m_initialFill;
+    std::vector<StateSet> m_variables;
+
+    std::unordered_map<const MuFormula*, int> m_closedRegisters;
+    std::vector<bool> m_permanent;
+    std::vector<int> m_freeRegisters;
+    std::vector<StateSet> m_registers;
+    StateSet m_scratch;
+};
+
+#endif // TOOL_FORMULAPROGRAM_H_
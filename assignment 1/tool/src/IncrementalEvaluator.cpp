@@ -0,0 +1,422 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IncrementalEvaluator.h"
+
+#include <algorithm>
+#include <assert.h>
+
+IncrementalEvaluator::IncrementalEvaluator(LabelledTransitionSystem& system, MuFormula& formula) :
+    m_system(system)
+{
+    std::map<std::string, Variable*> scope;
+    std::vector<Variable*> usedVariables;
+    m_root = build(&formula, scope, usedVariables);
+}
+
+const StateSet& IncrementalEvaluator::solve()
+{
+    update(*m_root);
+    return m_root->value;
+}
+
+IncrementalEvaluator::Node* IncrementalEvaluator::build(MuFormula* formula, std::map<std::string, Variable*>& scope, std::vector<Variable*>& usedVariables)
+{
+    m_nodes.push_back(Node());
+    Node& node = m_nodes.back();
+    node.operation = formula->getOperation();
+    node.left = nullptr;
+    node.right = nullptr;
+    node.label = -1;
+    node.variable = nullptr;
+    node.initialised = false;
+    node.seenVersion = 0;
+
+    switch (node.operation) {
+    case FALSE:
+    case TRUE:
+        break;
+    case VAR: {
+        auto binder = scope.find(formula->getVarLabel());
+        if (binder == scope.end()) {
+            // A variable that is not bound by any fixpoint is always empty.
+            m_variables.push_back(Variable());
+            Variable& unbound = m_variables.back();
+            unbound.value = StateSet(m_system.getNumStates());
+            unbound.version = unbound.increases = unbound.decreases = 0;
+            binder = scope.insert(std::make_pair(formula->getVarLabel(), &unbound)).first;
+        }
+
+        node.variable = binder->second;
+        usedVariables.push_back(node.variable);
+        break;
+    }
+    case AND:
+    case OR:
+        node.left = build(formula->getSubformula(), scope, usedVariables);
+        node.right = build(formula->getSubformula2(), scope, usedVariables);
+        break;
+    case DIAMOND:
+    case BOX:
+        node.label = m_system.getLabelIndex(formula->getVarLabel());
+        node.left = build(formula->getSubformula(), scope, usedVariables);
+        break;
+    case MU:
+    case NU: {
+        m_variables.push_back(Variable());
+        Variable& variable = m_variables.back();
+        variable.value = StateSet(m_system.getNumStates(), node.operation == NU);
+        variable.version = variable.increases = variable.decreases = 0;
+        node.variable = &variable;
+
+        // Bind the variable in the body, restoring a shadowed binder afterwards.
+        const std::string& name = formula->getVarLabel();
+        auto shadowed = scope.find(name);
+        Variable* previous = (shadowed != scope.end()) ? shadowed->second : nullptr;
+        scope[name] = &variable;
+
+        std::vector<Variable*> bodyVariables;
+        node.left = build(formula->getSubformula(), scope, bodyVariables);
+
+        if (previous != nullptr) {
+            scope[name] = previous;
+        }
+        else {
+            scope.erase(name);
+        }
+
+        // Every variable of the body except the bound one is free in this fixpoint.
+        std::sort(bodyVariables.begin(), bodyVariables.end());
+        bodyVariables.erase(std::unique(bodyVariables.begin(), bodyVariables.end()), bodyVariables.end());
+        for (Variable* used : bodyVariables) {
+            if (used != &variable) {
+                node.freeVariables.push_back(used);
+                usedVariables.push_back(used);
+            }
+        }
+
+        node.seenIncreases.resize(node.freeVariables.size());
+        node.seenDecreases.resize(node.freeVariables.size());
+        break;
+    }
+    }
+
+    return &node;
+}
+
+void IncrementalEvaluator::update(Node& node)
+{
+    node.added.clear();
+    node.removed.clear();
+
+    switch (node.operation) {
+    case FALSE:
+        if (!node.initialised) {
+            node.value = StateSet(m_system.getNumStates());
+            node.initialised = true;
+        }
+        break;
+    case TRUE:
+        if (!node.initialised) {
+            node.value = m_system.getSetOfStates();
+            node.initialised = true;
+        }
+        break;
+    case VAR:
+        updateVariable(node);
+        break;
+    case AND:
+    case OR:
+        updateLogic(node);
+        break;
+    case DIAMOND:
+        updateDiamond(node);
+        break;
+    case BOX:
+        updateBox(node);
+        break;
+    case MU:
+    case NU:
+        updateFixpoint(node);
+        break;
+    }
+}
+
+void IncrementalEvaluator::updateVariable(Node& node)
+{
+    Variable& variable = *node.variable;
+
+    if (!node.initialised) {
+        node.value = variable.value;
+        node.seenVersion = variable.version;
+        node.initialised = true;
+        return;
+    }
+
+    if (variable.version == node.seenVersion) {
+        return; // Nothing changed since the last update.
+    }
+
+    if (variable.version == node.seenVersion + 1) {
+        // Only the last change was missed, so take over its difference.
+        node.added = variable.added;
+        node.removed = variable.removed;
+        for (int state : node.added) {
+            node.value.insert(state);
+        }
+        for (int state : node.removed) {
+            node.value.erase(state);
+        }
+    }
+    else {
+        node.value.getChanges(variable.value, node.added, node.removed);
+        node.value = variable.value;
+    }
+
+    node.seenVersion = variable.version;
+}
+
+void IncrementalEvaluator::updateLogic(Node& node)
+{
+    Node& left = *node.left;
+    Node& right = *node.right;
+    update(left);
+    update(right);
+
+    if (!node.initialised) {
+        node.value = left.value;
+        if (node.operation == AND) {
+            node.value &= right.value;
+        }
+        else {
+            node.value |= right.value;
+        }
+        node.initialised = true;
+        return;
+    }
+
+    // Only the states that changed in one of the subformulas have to be reconsidered.
+    bool isAnd = (node.operation == AND);
+    auto reconsider = [&](const std::vector<int>& states) {
+        for (int state : states) {
+            bool holds = isAnd ? (left.value.contains(state) && right.value.contains(state))
+                : (left.value.contains(state) || right.value.contains(state));
+
+            if (holds != node.value.contains(state)) {
+                if (holds) {
+                    node.value.insert(state);
+                    node.added.push_back(state);
+                }
+                else {
+                    node.value.erase(state);
+                    node.removed.push_back(state);
+                }
+            }
+        }
+    };
+
+    reconsider(left.added);
+    reconsider(left.removed);
+    reconsider(right.added);
+    reconsider(right.removed);
+}
+
+void IncrementalEvaluator::updateDiamond(Node& node)
+{
+    Node& sub = *node.left;
+    update(sub);
+
+    if (node.label < 0) {
+        // No state has a transition with this label.
+        if (!node.initialised) {
+            node.value = StateSet(m_system.getNumStates());
+            node.initialised = true;
+        }
+        return;
+    }
+
+    // The counter of a state is its number of successors satisfying the subformula.
+    if (!node.initialised) {
+        node.counters.assign(m_system.getNumStates(), 0);
+        node.value = StateSet(m_system.getNumStates());
+        for (int toState : sub.value) {
+            for (int fromState : m_system.getFromStates(toState, node.label)) {
+                if (node.counters[fromState]++ == 0) {
+                    node.value.insert(fromState);
+                }
+            }
+        }
+        node.initialised = true;
+        return;
+    }
+
+    for (int toState : sub.added) {
+        for (int fromState : m_system.getFromStates(toState, node.label)) {
+            if (node.counters[fromState]++ == 0) {
+                node.value.insert(fromState);
+                node.added.push_back(fromState);
+            }
+        }
+    }
+
+    for (int toState : sub.removed) {
+        for (int fromState : m_system.getFromStates(toState, node.label)) {
+            if (--node.counters[fromState] == 0) {
+                node.value.erase(fromState);
+                node.removed.push_back(fromState);
+            }
+        }
+    }
+}
+
+void IncrementalEvaluator::updateBox(Node& node)
+{
+    Node& sub = *node.left;
+    update(sub);
+
+    if (node.label < 0) {
+        // No state has a transition with this label.
+        if (!node.initialised) {
+            node.value = m_system.getSetOfStates();
+            node.initialised = true;
+        }
+        return;
+    }
+
+    // The counter of a state is its number of successors not satisfying the subformula.
+    if (!node.initialised) {
+        node.counters.assign(m_system.getNumStates(), 0);
+        node.value = m_system.getSetOfStates();
+
+        StateSet outside = sub.value;
+        outside.complement();
+        for (int toState : outside) {
+            for (int fromState : m_system.getFromStates(toState, node.label)) {
+                if (node.counters[fromState]++ == 0) {
+                    node.value.erase(fromState);
+                }
+            }
+        }
+        node.initialised = true;
+        return;
+    }
+
+    for (int toState : sub.added) {
+        for (int fromState : m_system.getFromStates(toState, node.label)) {
+            if (--node.counters[fromState] == 0) {
+                node.value.insert(fromState);
+                node.added.push_back(fromState);
+            }
+        }
+    }
+
+    for (int toState : sub.removed) {
+        for (int fromState : m_system.getFromStates(toState, node.label)) {
+            if (node.counters[fromState]++ == 0) {
+                node.value.erase(fromState);
+                node.removed.push_back(fromState);
+            }
+        }
+    }
+}
+
+void IncrementalEvaluator::updateFixpoint(Node& node)
+{
+    Variable& variable = *node.variable;
+    Node& body = *node.left;
+
+    bool wasInitialised = node.initialised;
+    bool reset = !wasInitialised;
+
+    // The previous solution is only a valid start when the free variables moved in the direction of the fixpoint.
+    for (size_t i = 0; i < node.freeVariables.size() && wasInitialised; ++i) {
+        if (node.operation == MU && node.freeVariables[i]->decreases != node.seenDecreases[i]) {
+            reset = true;
+        }
+        else if (node.operation == NU && node.freeVariables[i]->increases != node.seenIncreases[i]) {
+            reset = true;
+        }
+    }
+
+    StateSet previous;
+    if (wasInitialised) {
+        previous = node.value;
+    }
+
+    if (reset) {
+        assignVariable(variable, StateSet(m_system.getNumStates(), node.operation == NU));
+    }
+
+    // Indicates that the approximation equals the result of the body before its update.
+    bool synchronised = !reset;
+
+    while (true) {
+        update(body);
+
+        if (synchronised) {
+            if (body.added.empty() && body.removed.empty()) {
+                break;
+            }
+            changeVariable(variable, body.added, body.removed);
+        }
+        else {
+            if (variable.value == body.value) {
+                break;
+            }
+            assignVariable(variable, body.value);
+            synchronised = true;
+        }
+    }
+
+    for (size_t i = 0; i < node.freeVariables.size(); ++i) {
+        node.seenIncreases[i] = node.freeVariables[i]->increases;
+        node.seenDecreases[i] = node.freeVariables[i]->decreases;
+    }
+
+    node.value = variable.value;
+    if (wasInitialised) {
+        previous.getChanges(node.value, node.added, node.removed);
+    }
+    node.initialised = true;
+}
+
+void IncrementalEvaluator::assignVariable(Variable& variable, const StateSet& value)
+{
+    variable.added.clear();
+    variable.removed.clear();
+    variable.value.getChanges(value, variable.added, variable.removed);
+    variable.value = value;
+
+    ++variable.version;
+    variable.increases += variable.added.empty() ? 0 : 1;
+    variable.decreases += variable.removed.empty() ? 0 : 1;
+}
+
+void IncrementalEvaluator::changeVariable(Variable& variable, const std::vector<int>& added, const std::vector<int>& removed)
+{
+    variable.added = added;
+    variable.removed = removed;
+    for (int state : added) {
+        variable.value.insert(state);
+    }
+    for (int state : removed) {
+        variable.value.erase(state);
+    }
+
+    ++variable.version;
+    variable.increases += added.empty() ? 0 : 1;
+    variable.decreases += removed.empty() ? 0 : 1;
+}
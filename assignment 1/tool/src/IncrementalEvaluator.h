@@ -0,0 +1,133 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_INCREMENTALEVALUATOR_H_
+#define TOOL_INCREMENTALEVALUATOR_H_
+
+#include "LabelledTransitionSystem.h"
+#include "MuCalculus.h"
+#include "StateSet.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Evaluates a mu-calculus formula by propagating changes instead of recomputing subformulas.
+ *
+ * Every subformula keeps its last result together with the states that were added to or removed
+ * from it by its last update. Diamond and box keep, per state, the number of successors inside
+ * (respectively outside) the result of their subformula, so that a change of a single state only
+ * visits its predecessors. A fixpoint iteration stops as soon as an update of its body does not
+ * change anything.
+ *
+ * A fixpoint continues from its previous solution when its free variables only changed in the
+ * direction of the fixpoint (growing for mu, shrinking for nu), as in Emerson-Lei, and is reset
+ * to its initial approximation otherwise.
+ */
+class IncrementalEvaluator
+{
+public:
+    IncrementalEvaluator(LabelledTransitionSystem& system, MuFormula& formula);
+
+    /**
+     * Returns the set of states in which the formula holds.
+     */
+    const StateSet& solve();
+
+private:
+    /**
+     * The approximation of a fixpoint variable.
+     *
+     * @version is increased on every change, with added and removed the states of that change.
+     * @increases, @decreases count the changes that added respectively removed states.
+     */
+    struct Variable
+    {
+        StateSet value;
+        unsigned version;
+        unsigned increases;
+        unsigned decreases;
+        std::vector<int> added;
+        std::vector<int> removed;
+    };
+
+    /**
+     * An occurrence of a subformula with its last result and the changes made by its last update.
+     *
+     * @label is the transition label index in case of DIAMOND and BOX, -1 if it does not occur.
+     * @variable is the referenced or bound variable in case of VAR, MU and NU.
+     * @counters is the per state number of relevant successors in case of DIAMOND and BOX.
+     * @freeVariables, @seenIncreases, @seenDecreases are the free variables of a fixpoint and
+     * their change counts at its last update.
+     * @seenVersion is the version of the variable at the last update in case of VAR.
+     */
+    struct Node
+    {
+        Op operation;
+        Node* left;
+        Node* right;
+        int label;
+        Variable* variable;
+
+        bool initialised;
+        StateSet value;
+        std::vector<int> added;
+        std::vector<int> removed;
+
+        std::vector<int> counters;
+        std::vector<Variable*> freeVariables;
+        std::vector<unsigned> seenIncreases;
+        std::vector<unsigned> seenDecreases;
+        unsigned seenVersion;
+    };
+
+    /**
+     * Creates the nodes for formula, scope maps the variable names to the innermost binder.
+     * The variables occurring in formula are added to usedVariables.
+     */
+    Node* build(MuFormula* formula, std::map<std::string, Variable*>& scope, std::vector<Variable*>& usedVariables);
+
+    /**
+     * Brings the result of the node up to date with the current variable approximations.
+     */
+    void update(Node& node);
+
+    void updateVariable(Node& node);
+    void updateLogic(Node& node);
+    void updateDiamond(Node& node);
+    void updateBox(Node& node);
+    void updateFixpoint(Node& node);
+
+    /**
+     * Replaces the value of the variable by value, recording the difference as its last change.
+     */
+    void assignVariable(Variable& variable, const StateSet& value);
+
+    /**
+     * Applies the changes in added and removed to the variable.
+     */
+    void changeVariable(Variable& variable, const std::vector<int>& added, const std::vector<int>& removed);
+
+    LabelledTransitionSystem& m_system;
+    Node* m_root;
+
+    std::deque<Node> m_nodes;
+    std::deque<Variable> m_variables;
+};
+
+#endif // TOOL_INCREMENTALEVALUATOR_H_
@@ -15,90 +15,779 @@
  */
 
 #include "LabelledTransitionSystem.h"
+#include "MappedFile.h"
 
-#include <iostream>
-#include <regex>
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <cstdio>
 #include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdint.h>
+#include <string.h>
 #include <string>
+#include <sys/stat.h>
+#include <thread>
+
+/**
+ * Skips spaces, tabs and carriage returns.
+ */
+static const char* skipSpaces(const char* cursor, const char* end)
+{
+    while (cursor != end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+        ++cursor;
+    }
+    return cursor;
+}
+
+/**
+ * Skips the given character, preceded by optional spaces, returns false if it is not there.
+ */
+static bool skipCharacter(const char*& cursor, const char* end, char character)
+{
+    cursor = skipSpaces(cursor, end);
+    if (cursor == end || *cursor != character) {
+        return false;
+    }
+
+    ++cursor;
+    return true;
+}
+
+/**
+ * Reads a non-negative decimal number, preceded by optional spaces.
+ */
+static bool readNumber(const char*& cursor, const char* end, int& value)
+{
+    cursor = skipSpaces(cursor, end);
+    if (cursor == end || *cursor < '0' || *cursor > '9') {
+        return false;
+    }
+
+    long long result = 0;
+    while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+        result = result * 10 + (*cursor - '0');
+        if (result > 0x7FFFFFFF) {
+            return false;
+        }
+        ++cursor;
+    }
+
+    value = (int)result;
+    return true;
+}
+
+/**
+ * Reads a transition label, which is either quoted or runs up to the next comma.
+ */
+static bool readLabel(const char*& cursor, const char* end, const char*& label, size_t& length)
+{
+    cursor = skipSpaces(cursor, end);
+    if (cursor != end && *cursor == '"') {
+        label = ++cursor;
+        while (cursor != end && *cursor != '"' && *cursor != '\n') {
+            ++cursor;
+        }
+        if (cursor == end || *cursor != '"') {
+            return false;
+        }
+        length = cursor - label;
+        ++cursor;
+        return true;
+    }
+
+    label = cursor;
+    while (cursor != end && *cursor != ',' && *cursor != '\n') {
+        ++cursor;
+    }
+
+    // Trailing spaces are not part of the label.
+    const char* last = cursor;
+    while (last != label && (last[-1] == ' ' || last[-1] == '\t')) {
+        --last;
+    }
+    length = last - label;
+    return length > 0;
+}
+
+/**
+ * Moves the cursor past the end of the current line.
+ */
+static const char* nextLine(const char* cursor, const char* end)
+{
+    while (cursor != end && *cursor++ != '\n') {}
+    return cursor;
+}
+
+/**
+ * Returns whether the rest of the line only contains white space.
+ */
+static bool isEmptyLine(const char* cursor, const char* end)
+{
+    cursor = skipSpaces(cursor, end);
+    return cursor == end || *cursor == '\n';
+}
+
+/**
+ * Interns the transition labels directly from the file contents, such that a label is only
+ * copied into a string the first time it occurs.
+ */
+class LabelTable
+{
+public:
+    explicit LabelTable(std::vector<std::string>& labels) :
+        m_labels(labels),
+        m_slots(64, -1)
+    {
+        for (int index = 0; index < (int)m_labels.size(); ++index) {
+            insert(index);
+        }
+    }
+
+    /**
+     * Returns the index of the label, adding it if it was not yet known.
+     */
+    int intern(const char* label, size_t length)
+    {
+        size_t mask = m_slots.size() - 1;
+        for (size_t slot = hash(label, length) & mask; ; slot = (slot + 1) & mask) {
+            int index = m_slots[slot];
+            if (index < 0) {
+                break;
+            }
+
+            const std::string& known = m_labels[index];
+            if (known.size() == length && memcmp(known.data(), label, length) == 0) {
+                return index;
+            }
+        }
+
+        m_labels.push_back(std::string(label, length));
+        insert((int)m_labels.size() - 1);
+        return (int)m_labels.size() - 1;
+    }
+
+private:
+    /**
+     * Computes the FNV-1a hash of the label.
+     */
+    static size_t hash(const char* label, size_t length)
+    {
+        uint32_t result = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            result = (result ^ (unsigned char)label[i]) * 16777619u;
+        }
+        return result;
+    }
+
+    void insert(int index)
+    {
+        // Keep the table at most half full.
+        if (m_labels.size() * 2 > m_slots.size()) {
+            m_slots.assign(m_slots.size() * 2, -1);
+            for (int other = 0; other < index; ++other) {
+                place(other);
+            }
+        }
+        place(index);
+    }
+
+    void place(int index)
+    {
+        size_t mask = m_slots.size() - 1;
+        const std::string& label = m_labels[index];
+        size_t slot = hash(label.data(), label.size()) & mask;
+        while (m_slots[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = index;
+    }
+
+    std::vector<std::string>& m_labels;
+    std::vector<int> m_slots;
+};
+
+/**
+ * Runs task(index) for every index below numTasks, each on its own thread.
+ */
+static void runInParallel(size_t numTasks, const std::function<void(size_t)>& task)
+{
+    std::vector<std::thread> threads;
+    for (size_t index = 1; index < numTasks; ++index) {
+        threads.push_back(std::thread(task, index));
+    }
+
+    if (numTasks > 0) {
+        task(0);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Returns the first index of the part-th of numParts equally sized parts of size elements.
+ */
+static size_t partBegin(size_t size, size_t part, size_t numParts)
+{
+    return size / numParts * part + std::min(part, size % numParts);
+}
+
+struct LabelledTransitionSystem::TransitionChunk
+{
+    // The lines of the file in this chunk.
+    const char* first;
+    const char* last;
+
+    // The (from, label, to) triples, the labels index into labelNames.
+    std::vector<int> fromStates;
+    std::vector<int> labels;
+    std::vector<int> toStates;
+    std::vector<std::string> labelNames;
+
+    // The start of the first line that could not be read, with the offending state or -1 if the line was malformed.
+    const char* error;
+    int errorState;
+};
+
+void LabelledTransitionSystem::parseChunk(TransitionChunk& chunk, int numStates)
+{
+    LabelTable labelTable(chunk.labelNames);
+
+    const char* cursor = chunk.first;
+    const char* end = chunk.last;
+    while (cursor != end) {
+        if (isEmptyLine(cursor, end)) {
+            cursor = nextLine(cursor, end);
+            continue;
+        }
+
+        // (start_state : int, transition_label : string, end_state : int)
+        const char* line = cursor;
+        int fromState;
+        int toState;
+        const char* label;
+        size_t length;
+        if (!skipCharacter(cursor, end, '(')
+            || !readNumber(cursor, end, fromState) || !skipCharacter(cursor, end, ',')
+            || !readLabel(cursor, end, label, length) || !skipCharacter(cursor, end, ',')
+            || !readNumber(cursor, end, toState) || !skipCharacter(cursor, end, ')')) {
+            chunk.error = line;
+            chunk.errorState = -1;
+            return;
+        }
+
+        // Check that state numbers do not exceed the state numbers.
+        if (fromState >= numStates || toState >= numStates) {
+            chunk.error = line;
+            chunk.errorState = (fromState >= numStates) ? fromState : toState;
+            return;
+        }
+
+        chunk.fromStates.push_back(fromState);
+        chunk.labels.push_back(labelTable.intern(label, length));
+        chunk.toStates.push_back(toState);
+
+        cursor = nextLine(cursor, end);
+    }
+}
 
 bool LabelledTransitionSystem::parseAldebaranFormat(const char* strFilename, LabelledTransitionSystem& system)
 {
     assert(strFilename != nullptr); // nullptr is not allowed.
 
-    std::ifstream file(strFilename);
-    if (file.fail()) {
+    MappedFile file;
+    if (!file.open(strFilename)) {
         std::cerr << "Failed to open file " << strFilename << std::endl; return false;
     }
 
-    bool firstLine = true;
-    int numOfStates = -1;
+    const char* cursor = file.begin();
+    const char* end = file.end();
+
+    // des(<first_state> : int, <number_of_transitions> : int, <number_of_states> : int)
+    int numberOfTransitions = 0;
+    int numOfStates = 0;
+    cursor = skipSpaces(cursor, end);
+    if (end - cursor < 3 || memcmp(cursor, "des", 3) != 0) {
+        std::cerr << "File " << strFilename << " does not contain a des header." << std::endl; return false;
+    }
+
+    cursor += 3;
+    if (!skipCharacter(cursor, end, '(')
+        || !readNumber(cursor, end, system.m_firstState) || !skipCharacter(cursor, end, ',')
+        || !readNumber(cursor, end, numberOfTransitions) || !skipCharacter(cursor, end, ',')
+        || !readNumber(cursor, end, numOfStates) || !skipCharacter(cursor, end, ')')) {
+        std::cerr << "File " << strFilename << " has a malformed des header." << std::endl; return false;
+    }
+    cursor = nextLine(cursor, end);
 
-    std::string line;
-    while (std::getline(file, line)) {
+    // Split the transitions at line boundaries into chunks of at least a few megabytes, that are read in parallel.
+    const size_t minimumChunkSize = 4 << 20;
+    size_t size = end - cursor;
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t numChunks = std::max<size_t>(1, std::min(numThreads, size / minimumChunkSize));
 
-        if (firstLine) {
-            // des(<first_state> : int, <number_of_transitions> : int, <number_of_states> : int)
-            size_t firstBracket = line.find_first_of("(");
-            size_t firstComma = line.find_first_of(",");
+    std::vector<TransitionChunk> chunks(numChunks);
+    for (size_t index = 0; index < numChunks; ++index) {
+        TransitionChunk& chunk = chunks[index];
+        chunk.first = (index == 0) ? cursor : chunks[index - 1].last;
+        chunk.last = (index + 1 == numChunks) ? end : nextLine(std::max(chunk.first, cursor + partBegin(size, index + 1, numChunks)), end);
+        chunk.error = nullptr;
+        chunk.errorState = -1;
 
-            // Convert the first substring to a number.
-            system.m_firstState = std::atoi(line.substr(firstBracket + 1, firstComma - firstBracket).c_str());
+        // The header gives the number of transitions, so every chunk can reserve its share.
+        size_t share = (size_t)numberOfTransitions / numChunks;
+        chunk.fromStates.reserve(share);
+        chunk.labels.reserve(share);
+        chunk.toStates.reserve(share);
+    }
 
-            // Read the number of transitions.
-            std::string rest = line.substr(firstComma + 1);
-            size_t secondComma = rest.find_first_of(",");
-            int numberOfTransitions = std::atoi(rest.substr(0, secondComma).c_str());
+    runInParallel(numChunks, [&](size_t index) {
+        parseChunk(chunks[index], numOfStates);
+    });
 
-            // Read the number of states.
-            rest = rest.substr(secondComma + 1);
-            size_t secondBracket = rest.find_first_of(")");
-            int numStates = std::atoi(rest.substr(0, secondBracket).c_str());
-            system.m_stateTransitions = std::vector<std::map<std::string, std::set<int>>>(numStates);
-            numOfStates = numStates;
+    // Report the first line that could not be read.
+    for (auto& chunk : chunks) {
+        if (chunk.error != nullptr) {
+            if (chunk.errorState >= 0) {
+                std::cerr << "State " << chunk.errorState << " can't be added as index to vector."; return false;
+            }
 
-            firstLine = false;
+            long lineNumber = 1 + std::count(file.begin(), chunk.error, '\n');
+            std::cerr << "Line " << lineNumber << " of " << strFilename << " is not a transition." << std::endl; return false;
         }
-        else {
-            // (start_state : int, transition_label : string, end_state : int)
-            size_t firstBracket = line.find_first_of("(");
-            size_t firstComma = line.find_first_of(",");
+    }
 
-            // Read the first integer to start state.
-            int fromState = std::atoi(line.substr(firstBracket + 1, firstComma - firstBracket).c_str());
+    // Intern the labels of all chunks in file order, and replace the chunk label indices by the global ones.
+    system.m_labels.clear();
+    LabelTable labelTable(system.m_labels);
+    std::vector<std::vector<int>> globalLabels(numChunks);
+    for (size_t index = 0; index < numChunks; ++index) {
+        for (auto& name : chunks[index].labelNames) {
+            globalLabels[index].push_back(labelTable.intern(name.data(), name.size()));
+        }
+    }
 
-            // Convert to transition label.
-            std::string rest = line.substr(firstComma + 1);
-            size_t secondComma = rest.find_first_of(",");
-            std::string transitionLabel = rest.substr(1, secondComma - 2);
+    runInParallel(numChunks, [&](size_t index) {
+        for (int& label : chunks[index].labels) {
+            label = globalLabels[index][label];
+        }
+    });
+
+    system.m_labelIndices.clear();
+    for (int index = 0; index < (int)system.m_labels.size(); ++index) {
+        system.m_labelIndices[system.m_labels[index]] = index;
+    }
 
-            // Read the last integer as going state.
-            rest = rest.substr(secondComma + 1);
-            size_t secondBracket = rest.find_first_of(")");
-            int toState = std::atoi(rest.substr(0, secondBracket).c_str());
+    system.m_numStates = numOfStates;
+    system.buildIndex(chunks, false, numThreads, system.m_transitions);
+    system.buildIndex(chunks, true, numThreads, system.m_reverseTransitions);
+    system.m_cacheFile.reset();
 
-            // Check that state numbers do not exceed the state numbers (if they do change vector to map).
-            if (fromState >= system.m_stateTransitions.size() || fromState < 0) {
-                std::cerr << "State " << fromState << " can't be added as index to vector."; return false;
+    // Generate a set of a states that is accessed later on.
+    system.m_setOfStates = StateSet(numOfStates, true);
+
+    return true;
+}
+
+LabelledTransitionSystem::TransitionIndex::TransitionIndex() :
+    numRows(0),
+    numTransitions(0),
+    stateOffsets(nullptr),
+    rowLabels(nullptr),
+    rowOffsets(nullptr),
+    states(nullptr)
+{}
+
+StateRange LabelledTransitionSystem::TransitionIndex::find(int state, int label) const
+{
+    // States usually have transitions with only a few labels, for which a linear search is fastest.
+    for (uint64_t row = stateOffsets[state]; row < stateOffsets[state + 1]; ++row) {
+        if (rowLabels[row] >= label) {
+            if (rowLabels[row] != label) {
+                break;
             }
-            if (toState >= system.m_stateTransitions.size() || toState < 0) {
-                std::cerr << "State " << toState << " can't be added as index to vector."; return false;
+            return StateRange(states + rowOffsets[row], states + rowOffsets[row + 1]);
+        }
+    }
+
+    return StateRange(states, states);
+}
+
+void LabelledTransitionSystem::TransitionIndex::useStorage()
+{
+    numRows = rowLabelStorage.size();
+    numTransitions = stateStorage.size();
+    stateOffsets = stateOffsetStorage.data();
+    rowLabels = rowLabelStorage.data();
+    rowOffsets = rowOffsetStorage.data();
+    states = stateStorage.data();
+}
+
+bool LabelledTransitionSystem::TransitionIndex::isValid(int numStates, int numLabels) const
+{
+    if (stateOffsets[0] != 0 || stateOffsets[numStates] != numRows || rowOffsets[0] != 0 || rowOffsets[numRows] != numTransitions) {
+        return false;
+    }
+
+    for (int state = 0; state < numStates; ++state) {
+        if (stateOffsets[state] > stateOffsets[state + 1]) {
+            return false;
+        }
+
+        for (uint64_t row = stateOffsets[state]; row < stateOffsets[state + 1]; ++row) {
+            if (rowLabels[row] < 0 || rowLabels[row] >= numLabels
+                || (row > stateOffsets[state] && rowLabels[row] <= rowLabels[row - 1])) {
+                return false;
             }
+        }
+    }
 
-            system.m_stateTransitions[fromState][transitionLabel].insert(toState);
+    for (size_t row = 0; row < numRows; ++row) {
+        if (rowOffsets[row] > rowOffsets[row + 1]) {
+            return false;
         }
     }
 
-    // Generate a set of a states that is accessed later on.
-    for (int i = 0; i < numOfStates; i++) {
-        system.m_setOfStates.insert(i);
+    for (size_t index = 0; index < numTransitions; ++index) {
+        if (states[index] < 0 || states[index] >= numStates) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LabelledTransitionSystem::buildIndex(const std::vector<TransitionChunk>& chunks, bool reverse, size_t numThreads, TransitionIndex& index) const
+{
+    size_t numStates = m_numStates;
+    size_t numTransitions = 0;
+    for (auto& chunk : chunks) {
+        numTransitions += chunk.fromStates.size();
+    }
+
+    // Only use threads for the larger systems.
+    if (numTransitions < (1 << 20)) {
+        numThreads = 1;
+    }
+
+    // Count the transitions per state, every chunk is counted by its own thread.
+    std::vector<std::atomic<uint64_t>> counts(numStates + 1);
+    runInParallel(numThreads, [&](size_t part) {
+        for (size_t state = partBegin(numStates + 1, part, numThreads); state < partBegin(numStates + 1, part + 1, numThreads); ++state) {
+            counts[state].store(0, std::memory_order_relaxed);
+        }
+    });
+
+    runInParallel(chunks.size(), [&](size_t chunkIndex) {
+        const std::vector<int>& states = reverse ? chunks[chunkIndex].toStates : chunks[chunkIndex].fromStates;
+        for (int state : states) {
+            counts[state].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Compute the offsets of every state, and use the counts as the next free position of each state.
+    std::vector<uint64_t> offsets(numStates + 1);
+    uint64_t total = 0;
+    for (size_t state = 0; state <= numStates; ++state) {
+        offsets[state] = total;
+        total += counts[state].load(std::memory_order_relaxed);
+        counts[state].store(offsets[state], std::memory_order_relaxed);
+    }
+
+    // Place every transition of a state as its (label, other state) pair, such that sorting them groups them into rows.
+    std::vector<uint64_t> keys(numTransitions);
+    runInParallel(chunks.size(), [&](size_t chunkIndex) {
+        const TransitionChunk& chunk = chunks[chunkIndex];
+        const std::vector<int>& states = reverse ? chunk.toStates : chunk.fromStates;
+        const std::vector<int>& others = reverse ? chunk.fromStates : chunk.toStates;
+        for (size_t i = 0; i < states.size(); ++i) {
+            keys[counts[states[i]].fetch_add(1, std::memory_order_relaxed)] = ((uint64_t)chunk.labels[i] << 32) | (uint32_t)others[i];
+        }
+    });
+
+    // Sort the transitions of every state and remove duplicates, recording the remaining number of rows and transitions.
+    std::vector<uint64_t> rowCounts(numStates);
+    std::vector<uint64_t> transitionCounts(numStates);
+    runInParallel(numThreads, [&](size_t part) {
+        for (size_t state = partBegin(numStates, part, numThreads); state < partBegin(numStates, part + 1, numThreads); ++state) {
+            auto first = keys.begin() + offsets[state];
+            auto last = keys.begin() + offsets[state + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+
+            uint64_t rows = 0;
+            for (auto key = first; key != last; ++key) {
+                if (key == first || (*key >> 32) != (key[-1] >> 32)) {
+                    ++rows;
+                }
+            }
+            rowCounts[state] = rows;
+            transitionCounts[state] = last - first;
+        }
+    });
+
+    // Turn the counts into the first row and transition of every state.
+    index.stateOffsetStorage.resize(numStates + 1);
+    std::vector<uint64_t> firstTransitions(numStates + 1);
+    index.stateOffsetStorage[0] = 0;
+    firstTransitions[0] = 0;
+    for (size_t state = 0; state < numStates; ++state) {
+        index.stateOffsetStorage[state + 1] = index.stateOffsetStorage[state] + rowCounts[state];
+        firstTransitions[state + 1] = firstTransitions[state] + transitionCounts[state];
+    }
+
+    size_t numRows = index.stateOffsetStorage[numStates];
+    index.rowLabelStorage.resize(numRows);
+    index.rowOffsetStorage.resize(numRows + 1);
+    index.rowOffsetStorage[numRows] = firstTransitions[numStates];
+    index.stateStorage.resize(firstTransitions[numStates]);
+    runInParallel(numThreads, [&](size_t part) {
+        for (size_t state = partBegin(numStates, part, numThreads); state < partBegin(numStates, part + 1, numThreads); ++state) {
+            const uint64_t* key = keys.data() + offsets[state];
+            size_t row = index.stateOffsetStorage[state];
+            for (uint64_t position = firstTransitions[state]; position < firstTransitions[state + 1]; ++position, ++key) {
+                int label = (int)(*key >> 32);
+                if (position == firstTransitions[state] || label != index.rowLabelStorage[row - 1]) {
+                    index.rowLabelStorage[row] = label;
+                    index.rowOffsetStorage[row] = position;
+                    ++row;
+                }
+                index.stateStorage[position] = (int32_t)(uint32_t)*key;
+            }
+        }
+    });
+
+    index.useStorage();
+}
+
+/**
+ * The header of the binary cache format. It is followed by the label table, which stores every label
+ * as its 32-bit length followed by its characters and is padded to a multiple of eight bytes. Then follow
+ * the 64-bit state offset and row offset arrays of the transitions and the reverse transitions, and
+ * finally their 32-bit row label and state arrays. All numbers use the byte order of the machine that
+ * wrote the cache, which is checked by byteOrder.
+ */
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int64_t sourceSize;
+    int64_t sourceSeconds;
+    int64_t sourceNanoseconds;
+    int32_t initialState;
+    int32_t numStates;
+    int32_t numLabels;
+    int32_t reserved;
+    uint64_t numTransitions;
+    uint64_t numRows;
+    uint64_t numReverseRows;
+    uint64_t labelTableSize;
+};
+
+static const char cacheMagic[8] = { 'L', 'T', 'S', 'C', 'A', 'C', 'H', 'E' };
+static const uint32_t cacheVersion = 3;
+static const uint32_t cacheByteOrder = 0x01020304;
+
+/**
+ * Gets the size and modification time of a file, returns false if it does not exist.
+ */
+static bool getFileStamp(const char* strFilename, int64_t& size, int64_t& seconds, int64_t& nanoseconds)
+{
+    struct stat status;
+    if (stat(strFilename, &status) != 0) {
+        return false;
+    }
+
+    size = (int64_t)status.st_size;
+    seconds = (int64_t)status.st_mtime;
+#if defined(__APPLE__)
+    nanoseconds = (int64_t)status.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    nanoseconds = 0;
+#else
+    nanoseconds = (int64_t)status.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+LabelledTransitionSystem::LabelledTransitionSystem() :
+    m_firstState(0),
+    m_numStates(0)
+{}
+
+bool LabelledTransitionSystem::loadCache(const char* strCacheFilename, const char* strSourceFilename, LabelledTransitionSystem& system)
+{
+    assert(strCacheFilename != nullptr && strSourceFilename != nullptr); // nullptr is not allowed.
+
+    int64_t sourceSize;
+    int64_t sourceSeconds;
+    int64_t sourceNanoseconds;
+    if (!getFileStamp(strSourceFilename, sourceSize, sourceSeconds, sourceNanoseconds)) {
+        return false;
+    }
+
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (!file->open(strCacheFilename) || file->size() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, file->begin(), sizeof(CacheHeader));
+    if (memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || header.version != cacheVersion
+        || header.byteOrder != cacheByteOrder
+        || header.sourceSize != sourceSize
+        || header.sourceSeconds != sourceSeconds
+        || header.sourceNanoseconds != sourceNanoseconds
+        || header.numStates < 0 || header.numLabels < 0
+        || header.initialState < 0 || (header.numStates > 0 && header.initialState >= header.numStates)) {
+        return false;
+    }
+
+    // Check that the file contains exactly the arrays described by the header, the counts are bounded
+    // by the file size first such that computing the array sizes cannot overflow.
+    uint64_t numStates = (uint64_t)header.numStates;
+    if (header.numRows > file->size() || header.numReverseRows > file->size() || header.numTransitions > file->size()
+        || header.labelTableSize > file->size()) {
+        return false;
+    }
+
+    uint64_t offsetsSize = (2 * (numStates + 1) + header.numRows + 1 + header.numReverseRows + 1) * sizeof(uint64_t);
+    uint64_t arraysSize = offsetsSize + (header.numRows + header.numReverseRows + 2 * header.numTransitions) * sizeof(int32_t);
+    if (header.labelTableSize % 8 != 0 || file->size() != sizeof(CacheHeader) + header.labelTableSize + arraysSize) {
+        return false;
+    }
+
+    // Read the label table.
+    const char* cursor = file->begin() + sizeof(CacheHeader);
+    const char* labelTableEnd = cursor + header.labelTableSize;
+    system.m_labels.clear();
+    system.m_labelIndices.clear();
+    for (int32_t index = 0; index < header.numLabels; ++index) {
+        uint32_t length;
+        if (labelTableEnd - cursor < (ptrdiff_t)sizeof(length)) {
+            return false;
+        }
+        memcpy(&length, cursor, sizeof(length));
+        cursor += sizeof(length);
+
+        if ((uint64_t)(labelTableEnd - cursor) < length) {
+            return false;
+        }
+        system.m_labels.push_back(std::string(cursor, length));
+        system.m_labelIndices[system.m_labels.back()] = index;
+        cursor += length;
+    }
+
+    // The arrays are used in place, they are aligned since the mapping and the label table are.
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(labelTableEnd);
+    TransitionIndex& transitions = system.m_transitions;
+    TransitionIndex& reverseTransitions = system.m_reverseTransitions;
+    transitions.numRows = (size_t)header.numRows;
+    transitions.numTransitions = (size_t)header.numTransitions;
+    transitions.stateOffsets = offsets;
+    transitions.rowOffsets = transitions.stateOffsets + numStates + 1;
+    reverseTransitions.numRows = (size_t)header.numReverseRows;
+    reverseTransitions.numTransitions = (size_t)header.numTransitions;
+    reverseTransitions.stateOffsets = transitions.rowOffsets + header.numRows + 1;
+    reverseTransitions.rowOffsets = reverseTransitions.stateOffsets + numStates + 1;
+
+    const int32_t* values = reinterpret_cast<const int32_t*>(reverseTransitions.rowOffsets + header.numReverseRows + 1);
+    transitions.rowLabels = values;
+    transitions.states = transitions.rowLabels + header.numRows;
+    reverseTransitions.rowLabels = transitions.states + header.numTransitions;
+    reverseTransitions.states = reverseTransitions.rowLabels + header.numReverseRows;
+
+    // Check all offsets and states, such that a corrupt cache cannot cause reads outside the arrays.
+    for (TransitionIndex* index : { &transitions, &reverseTransitions }) {
+        if (!index->isValid(header.numStates, header.numLabels)) {
+            return false;
+        }
+    }
+
+    for (TransitionIndex* index : { &transitions, &reverseTransitions }) {
+        index->stateOffsetStorage.clear();
+        index->rowLabelStorage.clear();
+        index->rowOffsetStorage.clear();
+        index->stateStorage.clear();
+    }
+
+    system.m_firstState = header.initialState;
+    system.m_numStates = header.numStates;
+    system.m_cacheFile = std::move(file);
+
+    system.m_setOfStates = StateSet(system.m_numStates, true);
+    return true;
+}
+
+bool LabelledTransitionSystem::writeCache(const char* strCacheFilename, const char* strSourceFilename) const
+{
+    assert(strCacheFilename != nullptr && strSourceFilename != nullptr); // nullptr is not allowed.
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.byteOrder = cacheByteOrder;
+    if (!getFileStamp(strSourceFilename, header.sourceSize, header.sourceSeconds, header.sourceNanoseconds)) {
+        return false;
+    }
+    header.initialState = m_firstState;
+    header.numStates = m_numStates;
+    header.numLabels = (int32_t)m_labels.size();
+    header.numTransitions = m_transitions.numTransitions;
+    header.numRows = m_transitions.numRows;
+    header.numReverseRows = m_reverseTransitions.numRows;
+
+    std::string labelTable;
+    for (auto& label : m_labels) {
+        uint32_t length = (uint32_t)label.size();
+        labelTable.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        labelTable.append(label);
+    }
+    labelTable.resize((labelTable.size() + 7) / 8 * 8, '\0');
+    header.labelTableSize = labelTable.size();
+
+    // Write to a temporary file first, such that a concurrent reader never sees a partial cache.
+    std::string temporaryFilename = std::string(strCacheFilename) + ".tmp";
+    {
+        std::ofstream file(temporaryFilename.c_str(), std::ios::binary | std::ios::trunc);
+        if (file.fail()) {
+            return false;
+        }
+
+        size_t numStates = m_numStates;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(labelTable.data(), labelTable.size());
+        for (const TransitionIndex* index : { &m_transitions, &m_reverseTransitions }) {
+            file.write(reinterpret_cast<const char*>(index->stateOffsets), (numStates + 1) * sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(index->rowOffsets), (index->numRows + 1) * sizeof(uint64_t));
+        }
+        for (const TransitionIndex* index : { &m_transitions, &m_reverseTransitions }) {
+            file.write(reinterpret_cast<const char*>(index->rowLabels), index->numRows * sizeof(int32_t));
+            file.write(reinterpret_cast<const char*>(index->states), index->numTransitions * sizeof(int32_t));
+        }
+        if (file.fail()) {
+            file.close();
+            std::remove(temporaryFilename.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporaryFilename.c_str(), strCacheFilename) != 0) {
+        std::remove(temporaryFilename.c_str());
+        return false;
     }
 
     return true;
 }
 
 int LabelledTransitionSystem::getNumStates() {
-    return (int)m_setOfStates.size();
+    return m_numStates;
 }
 
 int LabelledTransitionSystem::getInitialState()
@@ -106,12 +795,37 @@ int LabelledTransitionSystem::getInitialState()
     return m_firstState;
 }
 
-std::set<int>& LabelledTransitionSystem::getSetOfStates()
+const StateSet& LabelledTransitionSystem::getSetOfStates()
 {
     return m_setOfStates;
 }
 
-std::set<int>& LabelledTransitionSystem::getToStates(int state, const std::string& varLabel)
+int LabelledTransitionSystem::getNumLabels() const
 {
-    return m_stateTransitions[state][varLabel];
-}
\ No newline at end of file
+    return (int)m_labels.size();
+}
+
+int LabelledTransitionSystem::getLabelIndex(const std::string& label) const
+{
+    auto result = m_labelIndices.find(label);
+    if (result == m_labelIndices.end()) {
+        return -1;
+    }
+
+    return result->second;
+}
+
+const std::string& LabelledTransitionSystem::getLabel(int label) const
+{
+    return m_labels[label];
+}
+
+StateRange LabelledTransitionSystem::getToStates(int state, int label) const
+{
+    return m_transitions.find(state, label);
+}
+
+StateRange LabelledTransitionSystem::getFromStates(int state, int label) const
+{
+    return m_reverseTransitions.find(state, label);
+}
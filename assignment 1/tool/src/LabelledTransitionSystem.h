@@ -17,14 +17,48 @@
 #ifndef TOOL_LABELLEDTRANSITIONSYSTEM_H_
 #define TOOL_LABELLEDTRANSITIONSYSTEM_H_
 
-#include <set>
+#include "MappedFile.h"
+#include "StateSet.h"
+
+#include <memory>
+#include <stdint.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <map>
+
+/**
+ * A contiguous range of states, used to iterate over transition targets without copying them.
+ */
+class StateRange
+{
+public:
+    StateRange(const int* first, const int* last) :
+        m_first(first),
+        m_last(last)
+    {}
+
+    const int* begin() const { return m_first; }
+    const int* end() const { return m_last; }
+
+    size_t size() const { return m_last - m_first; }
+    bool empty() const { return m_first == m_last; }
+
+private:
+    const int* m_first;
+    const int* m_last;
+};
 
  /**
   * Contains the description of a linear transition system, consisting of initial state,
   * the set of states and transition relations.
+  *
+  * Action labels are interned to dense indices when parsing. The transitions are stored per state,
+  * in rows of the labels that state has transitions with, see TransitionIndex. Only non-empty rows are
+  * stored, so the memory used is linear in the number of states and transitions regardless of the
+  * number of labels. The reverse transitions are stored in the same way.
+  *
+  * These arrays either point into the vectors owned by the system, or into a memory mapped
+  * binary cache file, see writeCache and loadCache.
   */
 class LabelledTransitionSystem
 {
@@ -35,6 +69,20 @@ public:
      */
     static bool parseAldebaranFormat(const char* strFilename, LabelledTransitionSystem& system);
 
+    /**
+     * Maps the binary cache strCacheFilename into memory and uses its arrays without parsing. Returns false when
+     * the cache does not exist, is malformed, or was not written for the current contents of strSourceFilename.
+     */
+    static bool loadCache(const char* strCacheFilename, const char* strSourceFilename, LabelledTransitionSystem& system);
+
+    /**
+     * Writes the system to strCacheFilename in the binary cache format, recording the size and modification
+     * time, in nanoseconds, of strSourceFilename such that loadCache can detect a stale cache.
+     */
+    bool writeCache(const char* strCacheFilename, const char* strSourceFilename) const;
+
+    LabelledTransitionSystem();
+
     /**
      * Returns the number of states
      */
@@ -48,18 +96,104 @@ public:
     /**
      * Returns a set of all states
      */
-    std::set<int>& getSetOfStates();
+    const StateSet& getSetOfStates();
+
+    /**
+     * Returns the number of distinct transition labels.
+     */
+    int getNumLabels() const;
+
+    /**
+     * Returns the index of the transition label, or -1 if no transition carries this label.
+     */
+    int getLabelIndex(const std::string& label) const;
+
+    /**
+     * Returns the transition label with the given index.
+     */
+    const std::string& getLabel(int label) const;
 
     /**
-     * Returns all states reachable from state by a transition labelled varLabel
+     * Returns all states reachable from state by a transition labelled with the given label index.
      */
-    std::set<int>& getToStates(int state, const std::string& varLabel);
+    StateRange getToStates(int state, int label) const;
+
+    /**
+     * Returns all states that reach state by a transition labelled with the given label index.
+     */
+    StateRange getFromStates(int state, int label) const;
 
 private:
+    LabelledTransitionSystem(const LabelledTransitionSystem&);
+    LabelledTransitionSystem& operator=(const LabelledTransitionSystem&);
+
+    /**
+     * The transitions read from one chunk of an Aldebaran file.
+     */
+    struct TransitionChunk;
+
+    /**
+     * Reads the transition lines of a chunk, stops at the first line that is not a valid transition.
+     */
+    static void parseChunk(TransitionChunk& chunk, int numStates);
+
+    /**
+     * The transitions of every state grouped per label. The rows of state are stateOffsets[state] up to
+     * stateOffsets[state + 1], ordered by their label rowLabels[row], and row holds the states
+     * states[rowOffsets[row]] up to states[rowOffsets[row + 1]] in increasing order.
+     */
+    struct TransitionIndex
+    {
+        TransitionIndex();
+
+        /**
+         * Returns the states in the row of label of state, which is empty if there is no such row.
+         */
+        StateRange find(int state, int label) const;
+
+        /**
+         * Points the arrays into the storage vectors.
+         */
+        void useStorage();
+
+        /**
+         * Returns whether the offsets are increasing and end at the number of rows and transitions, the labels of
+         * every state are increasing, and all labels and states are in range. Used to check a loaded cache.
+         */
+        bool isValid(int numStates, int numLabels) const;
+
+        size_t numRows;
+        size_t numTransitions;
+        const uint64_t* stateOffsets;
+        const int32_t* rowLabels;
+        const uint64_t* rowOffsets;
+        const int32_t* states;
+
+        // The storage of the arrays when they were built by the parser.
+        std::vector<uint64_t> stateOffsetStorage;
+        std::vector<int32_t> rowLabelStorage;
+        std::vector<uint64_t> rowOffsetStorage;
+        std::vector<int32_t> stateStorage;
+    };
+
+    /**
+     * Builds the index of the transitions from the parsed chunks, grouped by their source state, or by
+     * their target state if reverse is set.
+     */
+    void buildIndex(const std::vector<TransitionChunk>& chunks, bool reverse, size_t numThreads, TransitionIndex& index) const;
+
     int m_firstState;
-    std::set<int> m_setOfStates;
-    std::vector<std::map<std::string, std::set<int>>> m_stateTransitions;
+    int m_numStates;
+    StateSet m_setOfStates;
+
+    std::vector<std::string> m_labels;
+    std::unordered_map<std::string, int> m_labelIndices;
+
+    TransitionIndex m_transitions;
+    TransitionIndex m_reverseTransitions;
 
+    // The cache file when the transition arrays were loaded from it.
+    std::unique_ptr<MappedFile> m_cacheFile;
 };
 
 
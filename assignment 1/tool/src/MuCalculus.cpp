@@ -9,129 +9,75 @@
 #include <iterator>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <vector>
 
 using std::ifstream;
 
+/**
+ * Identifies a formula by its operation, subformulas, varlabel and prevFixedPoint.
+ */
+typedef std::tuple<Op, MuFormula*, MuFormula*, std::string, char> FormulaKey;
+
+/**
+ * Maps the formulas created while parsing a file to their unique instance, and tracks the variables in scope.
+ */
+struct FormulaTable
+{
+    std::map<FormulaKey, MuFormula*> instances;
+
+    // The name each bound variable in scope is renamed to, and the number of binders of each variable.
+    std::map<std::string, std::string> scope;
+    std::map<std::string, int> numBinders;
+};
+
 /**
  * Parses a logic formula
  */
-MuFormula* parseLogicFormula(std::string line, char pfp, std::map<std::string, char>& vars);
+MuFormula* parseLogicFormula(std::string line, char pfp, FormulaTable& formulas);
 
 /**
  * Parses a subformula (line)
  * pfp is the last fixed point encountered (as defined in the header)
  */
-MuFormula* parseSubFormula(std::string line, char pfp, std::map<std::string, char>& vars);
+MuFormula* parseSubFormula(std::string line, char pfp, FormulaTable& formulas);
+
+/**
+ * Returns the unique formula with the given fields, creating it if it is not in formulas yet.
+ */
+static MuFormula* makeFormula(FormulaTable& formulas, MuFormula* f1, MuFormula* f2, Op op, const std::string& varlabel, char pfp)
+{
+    MuFormula*& formula = formulas.instances[std::make_tuple(op, f1, f2, varlabel, pfp)];
+    if (formula == nullptr) {
+        formula = new MuFormula(f1, f2, op, varlabel, pfp);
+    }
+    return formula;
+}
 
-MuFormula::MuFormula(MuFormula* f1, MuFormula* f2, Op op, std::string varlabel, char pfp, std::map<std::string, char> vars) :
+MuFormula::MuFormula(MuFormula* f1, MuFormula* f2, Op op, std::string varlabel, char pfp) :
     subformula(f1),
     subformula2(f2),
     operation(op),
     prevFixedPoint(pfp),
     varlabel(varlabel),
-    fixedPoints(vars),
     open(false)
-{}
-
-std::set<int> MuFormula::solve(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables, bool naive) {
-    std::set<int> result;
-
-    switch (operation) {
-    case FALSE:
-        return std::set<int>(); // return empty set of states
-    case TRUE:
-        return system.getSetOfStates(); // return set of all states
-        break;
-    case VAR: {
-        return variables[varlabel]; // return the approximation of the varlabel.
-    }
-    case AND: {
-        //intersect set of states of the two subformula results
-        std::set<int> subResult1 = subformula->solve(system, variables, naive);
-        std::set<int> subResult2 = subformula2->solve(system, variables, naive);
-        std::set_intersection(subResult1.begin(), subResult1.end(), subResult2.begin(), subResult2.end(),
-            std::inserter(result, result.begin()));
-        return result;
-    }
-    case OR: {
-        //unite set of states of the two subformula results
-        std::set<int> subResult1 = subformula->solve(system, variables, naive);
-        std::set<int> subResult2 = subformula2->solve(system, variables, naive);
-        std::set_union(subResult1.begin(), subResult1.end(), subResult2.begin(), subResult2.end(),
-            std::inserter(result, result.begin()));
-        return result;
-    }
-    case DIAMOND: {
-        std::set<int> subResult1 = subformula->solve(system, variables, naive);
-        //for each state
-        for (int i = 0; i < system.getNumStates(); i++) {
-            //for each out transition
-            for (auto& toState : system.getToStates(i, varlabel)) {
-                //if it has a transition with the correct label to a correct state, it complies with the formula
-                if (subResult1.count(toState) == 1) {
-                    result.insert(i);
-                    break;
-                }
-            }
-        }
-        return result;
+{
+    // The free variables are those of the subformulas, without the variable bound here.
+    if (subformula != nullptr) {
+        freeVariables = subformula->freeVariables;
     }
-    case BOX: {
-        std::set<int> subResult1 = subformula->solve(system, variables, naive);
-        result = system.getSetOfStates();
-        //for each state
-        for (int i = 0; i < system.getNumStates(); i++) {
-            //for each out transition
-            for (auto& toState : system.getToStates(i, varlabel)) {
-                //if it has a transition with the correct label to a wrong state, it does not comply with the formula
-                if (subResult1.count(toState) == 0) {
-                    result.erase(i);
-                    break;
-                }
-            }
-        }
-        return result;
+    if (subformula2 != nullptr) {
+        freeVariables.insert(subformula2->freeVariables.begin(), subformula2->freeVariables.end());
     }
-    case NU:
-        if (naive) {
-            result = system.getSetOfStates(); // Start with all sets.
-        }
-        else {
-            if (prevFixedPoint == 'm') {
-                subformula->openFormulaReset(system, variables, prevFixedPoint, operation);
-            }
-        }
-    case MU:
-        // Result is the approximation for the varlabel.
-        std::set<int>& approximation = variables[varlabel];
-
-        if (naive) {
-            approximation = result;
-        }
-        else {
-            if (prevFixedPoint == 'n') {
-                subformula->openFormulaReset(system, variables, prevFixedPoint, operation);
-            }
-        }
-
-        while (true) {
-            // Calculate the new approximation.
-            std::set<int> newApprox = subformula->solve(system, variables, naive);
-
-            // Check whether the fixed point is reached.
-            if (approximation == newApprox) {
-                break;
-            }
 
-            // Set the new approximation as the variable.
-            approximation = newApprox;
-        }
-
-        return approximation;
+    if (operation == VAR) {
+        freeVariables.insert(varlabel);
+    }
+    else if (operation == MU || operation == NU) {
+        freeVariables.erase(varlabel);
     }
 
-    assert(false); // One case was not handled;
-    return std::set<int>(); // return empty set of states
+    open = !freeVariables.empty();
 }
 
 MuFormula* MuFormula::parseMuFormula(const char* strFilename) {
@@ -145,55 +91,52 @@ MuFormula* MuFormula::parseMuFormula(const char* strFilename) {
     // read the formula, skipping whitelines and comments (starting with %) 
     std::string line;
     do {
-        std::getline(fin, line);
+        if (!std::getline(fin, line)) {
+            throw std::runtime_error(std::string("No formula in ") + strFilename);
+        }
     } while (line.length() < 2 || line.at(0) == '%');
     //remove spaces
     line.erase(std::remove(line.begin(), line.end(), ' '), line.end());
 
-    //parse the formula
-    std::map<std::string, char> variables;
-    return parseSubFormula(line, 'x', variables);
-}
-
-void MuFormula::openFormulaReset(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables, char surroundingBinder, Op originalFixpoint) {
-    if (open && (operation == NU || operation == MU)) {
-        resetFormula(system, variables, surroundingBinder, originalFixpoint);
+    //parse the formula, a malformed one leaves no subformulas behind
+    FormulaTable formulas;
+    try {
+        return parseSubFormula(line, 'x', formulas);
     }
-    else {
-        switch (operation) {
-        case FALSE:
-        case TRUE:
-        case VAR:
-            break;
-        case AND:
-        case OR:
-            subformula->openFormulaReset(system, variables, prevFixedPoint, operation);
-            subformula2->openFormulaReset(system, variables, prevFixedPoint, operation);
-            break;
-        case BOX:
-        case DIAMOND:
-            subformula->openFormulaReset(system, variables, prevFixedPoint, operation);
-            break;
-        case MU:
-            subformula->openFormulaReset(system, variables, prevFixedPoint, operation);
-            break;
-        case NU:
-            subformula->openFormulaReset(system, variables, prevFixedPoint, operation);
-            break;
+    catch (...) {
+        for (auto& instance : formulas.instances) {
+            delete instance.second;
         }
+        throw;
     }
 }
 
-void MuFormula::resetFormula(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables, char surroundingBinder, Op originalFixpoint) {
-    if (operation == originalFixpoint) {
-        if (surroundingBinder == 'm') {
-            variables[varlabel] = system.getSetOfStates();
-        } else {
-            variables[varlabel].clear();
+void MuFormula::deleteMuFormula(MuFormula* formula) {
+    // Every subformula is deleted once, even when it is shared.
+    std::set<MuFormula*> subformulas;
+    std::vector<MuFormula*> stack;
+    if (formula != nullptr) {
+        stack.push_back(formula);
+    }
+
+    while (!stack.empty()) {
+        MuFormula* current = stack.back();
+        stack.pop_back();
+        if (!subformulas.insert(current).second) {
+            continue;
+        }
+
+        if (current->subformula != nullptr) {
+            stack.push_back(current->subformula);
         }
-        subformula->openFormulaReset(system, variables, surroundingBinder, originalFixpoint);
+        if (current->subformula2 != nullptr) {
+            stack.push_back(current->subformula2);
+        }
+    }
+
+    for (MuFormula* subformula : subformulas) {
+        delete subformula;
     }
-    subformula->openFormulaReset(system, variables, surroundingBinder, originalFixpoint);
 }
 
 std::string MuFormula::toString() {
@@ -222,7 +165,7 @@ std::string MuFormula::toString() {
     return "Failed to parse MuFormula";
 }
 
-MuFormula* parseLogicFormula(std::string line, char pfp, std::map<std::string, char>& vars)
+MuFormula* parseLogicFormula(std::string line, char pfp, FormulaTable& formulas)
 {
     //get the operation
     int opIndex = -1;
@@ -258,156 +201,117 @@ MuFormula* parseLogicFormula(std::string line, char pfp, std::map<std::string, c
     std::string subformula2 = line.substr(opIndex + 2, line.length() - opIndex - 3);
 
     if (subformula1.at(0) == '(') {
-        sub1 = parseLogicFormula(subformula1, pfp, vars);
+        sub1 = parseLogicFormula(subformula1, pfp, formulas);
     }
     else {
-        sub1 = parseSubFormula(subformula1, pfp, vars);
+        sub1 = parseSubFormula(subformula1, pfp, formulas);
     }
     if (subformula2.at(0) == '(') {
-        sub2 = parseLogicFormula(subformula2, pfp, vars);
+        sub2 = parseLogicFormula(subformula2, pfp, formulas);
     }
     else {
-        sub2 = parseSubFormula(subformula2, pfp, vars);
+        sub2 = parseSubFormula(subformula2, pfp, formulas);
     }
 
     //return the formula
-    return new MuFormula(sub1, sub2, opIsAnd ? AND : OR, "", pfp, vars);
+    return makeFormula(formulas, sub1, sub2, opIsAnd ? AND : OR, "", pfp);
 }
 
-MuFormula* parseSubFormula(std::string line, char pfp, std::map<std::string, char>& vars)
+/**
+ * Parses a fixpoint formula with operation op (line).
+ *
+ * A variable that is bound more than once in the file is renamed apart at every later binder, such that
+ * every fixpoint has its own approximation when the variables are looked up by name.
+ */
+static MuFormula* parseFixpoint(std::string line, Op op, char pfp, FormulaTable& formulas)
+{
+    size_t dot = line.find('.');
+    if (dot == std::string::npos || dot <= 2) {
+        throw std::runtime_error("Fixpoint without a variable: " + line);
+    }
+    std::string var = line.substr(2, dot - 2);
+    int index = formulas.numBinders[var]++;
+    std::string name = (index == 0) ? var : var + "'" + std::to_string(index);
+
+    // Bind the new name in the body, and restore the variable it shadows afterwards.
+    auto binder = formulas.scope.find(var);
+    bool shadows = (binder != formulas.scope.end());
+    std::string shadowed = shadows ? binder->second : std::string();
+    formulas.scope[var] = name;
+
+    MuFormula* body = parseSubFormula(line.substr(dot + 1, line.length() - dot - 1), (op == MU) ? 'm' : 'n', formulas);
+
+    if (shadows) {
+        formulas.scope[var] = shadowed;
+    }
+    else {
+        formulas.scope.erase(var);
+    }
+
+    return makeFormula(formulas, body, nullptr, op, name, pfp);
+}
+
+MuFormula* parseSubFormula(std::string line, char pfp, FormulaTable& formulas)
 {
     switch (line.at(0)) {
     case 't':	//true
-        return new MuFormula(nullptr, nullptr, TRUE, "", pfp, vars);
+        return makeFormula(formulas, nullptr, nullptr, TRUE, "", pfp);
     case 'f':	//false
-        return new MuFormula(nullptr, nullptr, FALSE, "", pfp, vars);
+        return makeFormula(formulas, nullptr, nullptr, FALSE, "", pfp);
     case '(':	//start of logic formula
-        return parseLogicFormula(line, pfp, vars);
+        return parseLogicFormula(line, pfp, formulas);
     case '<': {	//diamond
         size_t end = line.find('>');
-        return new MuFormula(parseSubFormula(line.substr(end + 1, line.length() - end - 1), pfp, vars), nullptr, DIAMOND, line.substr(1, end - 1), pfp, vars);
+        if (end == std::string::npos) {
+            throw std::runtime_error("Unclosed label in " + line);
+        }
+        return makeFormula(formulas, parseSubFormula(line.substr(end + 1, line.length() - end - 1), pfp, formulas), nullptr, DIAMOND, line.substr(1, end - 1), pfp);
     }
     case '[': {	//box
         size_t end = line.find(']');
-        return new MuFormula(parseSubFormula(line.substr(end + 1, line.length() - end - 1), pfp, vars), nullptr, BOX, line.substr(1, end - 1), pfp, vars);
-    }
-    case 'm': { //greatest fixed point
-        size_t dot = line.find('.');
-        std::string var = line.substr(2, dot - 2);
-        vars[var] = 'm';
-        return new MuFormula(parseSubFormula(line.substr(dot + 1, line.length() - dot - 1), 'm', vars), nullptr, MU, var, pfp, vars);
+        if (end == std::string::npos) {
+            throw std::runtime_error("Unclosed label in " + line);
+        }
+        return makeFormula(formulas, parseSubFormula(line.substr(end + 1, line.length() - end - 1), pfp, formulas), nullptr, BOX, line.substr(1, end - 1), pfp);
     }
-    case 'n': { //least fixed point
-        size_t dot = line.find('.');
-        std::string var = line.substr(2, dot - 2);
-        vars[var] = 'n';
-        return new MuFormula(parseSubFormula(line.substr(dot + 1, line.length() - dot - 1), 'n', vars), nullptr, NU, var, pfp, vars);
+    case 'm':	//least fixed point
+        return parseFixpoint(line, MU, pfp, formulas);
+    case 'n':	//greatest fixed point
+        return parseFixpoint(line, NU, pfp, formulas);
+    default: {	//variable
+        auto binder = formulas.scope.find(line);
+        return makeFormula(formulas, nullptr, nullptr, VAR, (binder != formulas.scope.end()) ? binder->second : line, pfp);
     }
-    default:	//variable
-        return new MuFormula(nullptr, nullptr, VAR, line, pfp, vars);
     }
 
     assert(false); // All cases must be handled.
     return nullptr;
 }
 
-void MuFormula::initVarMaps(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables) {
-    if (operation == MU) {
-        variables[varlabel] = std::set<int>();
-    }
-    else if (operation == NU) {
-        variables[varlabel] = system.getSetOfStates();
-    }
-
-    if (operation == MU || operation == NU || operation == BOX || operation == DIAMOND) {
-        subformula->initVarMaps(system, variables);
-    }
-    else if (operation == AND || operation == OR) {
-        subformula->initVarMaps(system, variables);
-        subformula2->initVarMaps(system, variables);
-    }
+bool MuFormula::isOpen() const {
+    return open;
 }
 
-void MuFormula::setFormulaClosedness() {
-    if (open == false && (operation == MU || operation == NU)) {
-        std::set<std::string> childVars;
-        std::set<std::string> boundVars;
-
-        getChildVars(childVars);
-        getBoundVars(boundVars);
-
-        std::set<std::string> looseVars;
-        std::set_difference(childVars.begin(), childVars.end(), boundVars.begin(), boundVars.end(),
-            std::inserter(looseVars, looseVars.begin()));
-
-        setOpen(!looseVars.empty());
-        subformula->setFormulaClosedness();
-    }
-    else if (operation == BOX || operation == DIAMOND) {
-        subformula->setFormulaClosedness();
-    }
-    else if (operation == AND || operation == OR) {
-        subformula->setFormulaClosedness();
-        subformula2->setFormulaClosedness();
-    }
+const std::set<std::string>& MuFormula::getFreeVariables() const {
+    return freeVariables;
 }
 
-void MuFormula::getChildVars(std::set<std::string> &childVars) {
-    if (operation == MU || operation == NU || operation == VAR) {
-        childVars.insert(varlabel);
-    }
+Op MuFormula::getOperation() const {
+    return operation;
+}
 
-    switch (operation) {
-    case FALSE:
-    case TRUE:
-    case VAR:
-        break;
-    case AND:
-    case OR:
-        subformula->getChildVars(childVars);
-        subformula2->getChildVars(childVars);
-        break;
-    case BOX:
-    case DIAMOND:
-        subformula->getChildVars(childVars);
-        break;
-    case MU:
-        subformula->getChildVars(childVars);
-        break;
-    case NU:
-        subformula->getChildVars(childVars);
-        break;
-    }
+MuFormula* MuFormula::getSubformula() const {
+    return subformula;
 }
 
-void MuFormula::getBoundVars(std::set<std::string>& boundVars) {
-    if (operation == MU || operation == NU) {
-        boundVars.insert(varlabel);
-    }
+MuFormula* MuFormula::getSubformula2() const {
+    return subformula2;
+}
 
-    switch (operation) {
-    case FALSE:
-    case TRUE:
-    case VAR:
-        break;
-    case AND:
-    case OR:
-        subformula->getBoundVars(boundVars);
-        subformula2->getBoundVars(boundVars);
-        break;
-    case BOX:
-    case DIAMOND:
-        subformula->getBoundVars(boundVars);
-        break;
-    case MU:
-        subformula->getBoundVars(boundVars);
-        break;
-    case NU:
-        subformula->getBoundVars(boundVars);
-        break;
-    }
+const std::string& MuFormula::getVarLabel() const {
+    return varlabel;
 }
 
-void MuFormula::setOpen(bool open) {
-    this->open = open;
+char MuFormula::getPrevFixedPoint() const {
+    return prevFixedPoint;
 }
@@ -19,8 +19,9 @@
 
 #include "LabelledTransitionSystem.h"
 
-#include <string>
 #include <map>
+#include <set>
+#include <string>
 
 /*
 Represents the possible operations or values of the mu-calculus
@@ -46,7 +47,8 @@ subformula2 is only defined in case op in {AND, OR}
 
 varlabel is only defined in case op in
 - {DIAMOND, BOX} then it is a transition label
-- {VAR, MU, NU} then it is a variable name
+- {VAR, MU, NU} then it is a variable name, a variable bound more than once is renamed apart
+  while parsing, so the second binder of X is named X'1
 
 prevFixedPoint is either
 - 'm' if the previous fixed point was a least fixed point
@@ -54,35 +56,27 @@ prevFixedPoint is either
 - 'x' if there is no previous fixed point
 this is needed for the Emerson-Lei expansion on the algorithm
 
-fixedPoints maps all variables to the fixed point type they are bounded by
-all variables are included that are within this formula
+freeVariables are the variables that occur in this formula without being bound by it,
+the formula is open if there is one
+
+Formulas are hash-consed while parsing: equal subformulas with the same prevFixedPoint are
+represented by the same MuFormula, so a parsed formula is a DAG.
 */
 class MuFormula
 {
 public:
-	MuFormula(MuFormula* f1, MuFormula* f2, Op op, std::string varlabel, char pfp, std::map<std::string, char> vars);
+	MuFormula(MuFormula* f1, MuFormula* f2, Op op, std::string varlabel, char pfp);
 
-	/**
-     * Solves this mu-calculus formula
-     *
-     * variables contains a set for each fixpoint variable of the current approximation.
-     */
-    std::set<int> solve(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables, bool naive);
-    
     /**
-     * Parses a file for a MuFormula and returns the biggest MuFormula.
+     * Parses a file for a MuFormula and returns the biggest MuFormula, or nullptr if the file cannot
+     * be opened. Throws std::exception if the formula is malformed.
      */
 	static MuFormula* parseMuFormula(const char* strFilename);
 
 	/**
-	 * If the formula is open we reset the state of its varlabel
+	 * Deletes a formula returned by parseMuFormula together with its subformulas, which may be shared.
 	 */
-	void openFormulaReset(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables, char surroundingBinder, Op originalFixpoint);
-
-	/**
-	* openFormulaReset utility function.
-	*/
-	void resetFormula(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables, char surroundingBinder, Op originalFixpoint);
+	static void deleteMuFormula(MuFormula* formula);
 
     /**
      * Converts a MuFormula to a string (for testing purposes)
@@ -90,30 +84,39 @@ public:
 	std::string toString();
 
 	/**
-	 * Initialises the variables map.
-	 *
+	 * Returns whether a variable occurs in this formula without being bound by it.
 	 */
-	void initVarMaps(LabelledTransitionSystem& system, std::map<std::string, std::set<int>>& variables);
+	bool isOpen() const;
 
 	/**
-	 * Computes whether the formula is closed or not and sets the variable open accordingly.
+	 * Returns the variables that occur in this formula without being bound by it.
 	 */
-	void setFormulaClosedness();
+	const std::set<std::string>& getFreeVariables() const;
 
 	/**
- 	 * Returns the names of all of the used variables in the nested (sub-)formuli of this formula.
+	 * Returns the operation of this formula.
 	 */
-	void getChildVars(std::set<std::string> &childVars);
+	Op getOperation() const;
 
 	/**
-	* Returns the names of the bound variables in the nested (sub-)formuli of this formula.
-	*/
-	void getBoundVars(std::set<std::string> &boundVars);
+	 * Returns the first subformula, or nullptr if the operation has none.
+	 */
+	MuFormula* getSubformula() const;
+
+	/**
+	 * Returns the second subformula, or nullptr if the operation has none.
+	 */
+	MuFormula* getSubformula2() const;
+
+	/**
+	 * Returns the transition label or variable name, see varlabel.
+	 */
+	const std::string& getVarLabel() const;
 
 	/**
-	 * Setter for the bool open.
+	 * Returns the type of the surrounding fixed point, see prevFixedPoint.
 	 */
-	void setOpen(bool open);
+	char getPrevFixedPoint() const;
 
 private:
     MuFormula* subformula;
@@ -121,7 +124,7 @@ private:
     Op operation;
     std::string varlabel;
     char prevFixedPoint;
-	std::map<std::string, char> fixedPoints;
+	std::set<std::string> freeVariables;
 	bool open;
 };
 
@@ -0,0 +1,382 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ParityGameReduction.h"
+
+#include "ParityGame.h"
+#include "Preprocessing.h"
+#include "ZielonkaSolver.h"
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+ParityGameReduction::ParityGameReduction(LabelledTransitionSystem& system, MuFormula& formula) :
+    m_system(system),
+    m_maxPriority(0)
+{
+    m_root = compile(&formula, std::map<std::string, int>());
+}
+
+StateSet ParityGameReduction::solve()
+{
+    int numStates = m_system.getNumStates();
+    size_t numVertices = getNumVertices();
+
+    std::vector<int> owner(numVertices, 0);
+    std::vector<int> priority(numVertices, 0);
+    std::vector<Vertex> edgeSources;
+    std::vector<Vertex> edgeTargets;
+    std::vector<Configuration> successors;
+
+    // True is won by even and false by odd, as they loop forever.
+    priority[getVertex(TRUE_POSITION, 0)] = getPriority(TRUE_POSITION);
+    priority[getVertex(FALSE_POSITION, 0)] = getPriority(FALSE_POSITION);
+    for (int sink : { TRUE_POSITION, FALSE_POSITION }) {
+        edgeSources.push_back(getVertex(sink, 0));
+        edgeTargets.push_back(getVertex(sink, 0));
+    }
+
+    for (int position = 0; position < (int)m_positions.size(); ++position) {
+        for (int state = 0; state < numStates; ++state) {
+            Vertex vertex = getVertex(position, state);
+            owner[vertex] = getOwner(position);
+            priority[vertex] = getPriority(position);
+
+            getSuccessors(position, state, successors);
+            for (auto& successor : successors) {
+                edgeSources.push_back(vertex);
+                edgeTargets.push_back(getVertex(successor.first, successor.second));
+            }
+        }
+    }
+
+    ParityGame game(std::move(owner), std::move(priority), std::move(edgeSources), std::move(edgeTargets));
+    std::vector<bool> evenWins = solvePreprocessed(game, [](const ParityGame& subgame, unsigned) {
+        return solveParityGameZielonka(subgame, true);
+    }, 1);
+
+    StateSet result(numStates);
+    for (int state = 0; state < numStates; ++state) {
+        if (evenWins[getVertex(m_root, state)]) {
+            result.insert(state);
+        }
+    }
+    return result;
+}
+
+bool ParityGameReduction::holdsIn(int state)
+{
+    /**
+     * A vertex explored so far, where winner is -1 while it is undecided and remaining is the number
+     * of undecided successors.
+     */
+    struct LocalVertex
+    {
+        Configuration configuration;
+        int winner;
+        bool expanded;
+        size_t remaining;
+        std::vector<uint32_t> successors;
+        std::vector<uint32_t> predecessors;
+    };
+
+    // The explored vertices are numbered by 32-bit indices, so the whole game must fit them.
+    getNumVertices();
+
+    std::vector<LocalVertex> vertices;
+    std::unordered_map<size_t, uint32_t> indices;
+    std::deque<uint32_t> queue;
+
+    auto discover = [&](const Configuration& configuration) {
+        auto result = indices.emplace(getVertex(configuration.first, configuration.second), (uint32_t)vertices.size());
+        if (result.second) {
+            LocalVertex vertex;
+            vertex.configuration = configuration;
+            vertex.winner = (configuration.first == TRUE_POSITION) ? 0 : (configuration.first == FALSE_POSITION) ? 1 : -1;
+            vertex.expanded = false;
+            vertex.remaining = 0;
+            vertices.push_back(std::move(vertex));
+        }
+        return result.first->second;
+    };
+
+    // Decides the vertex and every predecessor that it forces, through the attractor of the winner.
+    std::vector<uint32_t> decided;
+    auto decide = [&](uint32_t index, int winner) {
+        vertices[index].winner = winner;
+        decided.assign(1, index);
+        while (!decided.empty()) {
+            uint32_t current = decided.back();
+            decided.pop_back();
+
+            for (auto predecessor : vertices[current].predecessors) {
+                LocalVertex& vertex = vertices[predecessor];
+                if (vertex.winner < 0 && (getOwner(vertex.configuration.first) == winner || --vertex.remaining == 0)) {
+                    vertex.winner = winner;
+                    decided.push_back(predecessor);
+                }
+            }
+        }
+    };
+
+    uint32_t root = discover(Configuration(m_root, state));
+    queue.push_back(root);
+
+    std::vector<Configuration> successors;
+    while (!queue.empty() && vertices[root].winner < 0) {
+        uint32_t index = queue.front();
+        queue.pop_front();
+        if (vertices[index].expanded || vertices[index].winner >= 0) {
+            continue;
+        }
+
+        // A vertex that only decided vertices move to is not needed, until another predecessor is found.
+        bool needed = (index == root);
+        for (auto predecessor : vertices[index].predecessors) {
+            needed = needed || vertices[predecessor].winner < 0;
+        }
+        if (!needed) {
+            continue;
+        }
+
+        const Configuration configuration = vertices[index].configuration;
+        getSuccessors(configuration.first, configuration.second, successors);
+
+        std::vector<uint32_t> targets;
+        for (auto& successor : successors) {
+            targets.push_back(discover(successor));
+        }
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+        int owner = getOwner(configuration.first);
+        int winner = -1;
+        size_t remaining = 0;
+        for (auto target : targets) {
+            vertices[target].predecessors.push_back(index);
+            if (vertices[target].winner < 0) {
+                ++remaining;
+                queue.push_back(target);
+            }
+            else if (vertices[target].winner == owner) {
+                winner = owner;
+            }
+        }
+
+        LocalVertex& vertex = vertices[index];
+        vertex.expanded = true;
+        vertex.remaining = remaining;
+        vertex.successors = std::move(targets);
+        if (winner < 0 && remaining == 0) {
+            winner = 1 - owner;
+        }
+        if (winner >= 0) {
+            decide(index, winner);
+        }
+    }
+
+    if (vertices[root].winner >= 0) {
+        return vertices[root].winner == 0;
+    }
+
+    // Solve the undecided vertices, where the decided ones are replaced by true and false.
+    std::vector<uint32_t> gameVertex(vertices.size());
+    std::vector<int> owner = { 0, 0 };
+    std::vector<int> priority = { getPriority(TRUE_POSITION), getPriority(FALSE_POSITION) };
+    for (uint32_t index = 0; index < vertices.size(); ++index) {
+        const LocalVertex& vertex = vertices[index];
+        if (vertex.winner >= 0) {
+            gameVertex[index] = vertex.winner;
+        }
+        else if (vertex.expanded) {
+            gameVertex[index] = (uint32_t)owner.size();
+            owner.push_back(getOwner(vertex.configuration.first));
+            priority.push_back(getPriority(vertex.configuration.first));
+        }
+    }
+
+    std::vector<Vertex> edgeSources = { 0, 1 };
+    std::vector<Vertex> edgeTargets = { 0, 1 };
+    for (uint32_t index = 0; index < vertices.size(); ++index) {
+        if (vertices[index].winner < 0 && vertices[index].expanded) {
+            for (auto successor : vertices[index].successors) {
+                edgeSources.push_back(gameVertex[index]);
+                edgeTargets.push_back(gameVertex[successor]);
+            }
+        }
+    }
+
+    ParityGame game(std::move(owner), std::move(priority), std::move(edgeSources), std::move(edgeTargets));
+    std::vector<bool> evenWins = solvePreprocessed(game, [](const ParityGame& subgame, unsigned) {
+        return solveParityGameZielonka(subgame, true);
+    }, 1);
+    return evenWins[gameVertex[root]];
+}
+
+int ParityGameReduction::compile(MuFormula* formula, const std::map<std::string, int>& binders)
+{
+    switch (formula->getOperation()) {
+    case TRUE:
+        return TRUE_POSITION;
+    case FALSE:
+        return FALSE_POSITION;
+    case VAR: {
+        // A free variable of the whole formula is empty.
+        auto binder = binders.find(formula->getVarLabel());
+        return (binder != binders.end()) ? binder->second : FALSE_POSITION;
+    }
+    default:
+        break;
+    }
+
+    PositionKey key(formula, std::vector<int>());
+    for (auto& variable : formula->getFreeVariables()) {
+        auto binder = binders.find(variable);
+        key.second.push_back((binder != binders.end()) ? binder->second : FALSE_POSITION);
+    }
+
+    auto compiled = m_compiled.find(key);
+    if (compiled != m_compiled.end()) {
+        return compiled->second;
+    }
+
+    int index = (int)m_positions.size();
+    Position position = { formula->getOperation(), -1, -1, -1, 0 };
+    m_positions.push_back(position);
+    m_compiled[key] = index;
+
+    switch (position.operation) {
+    case AND:
+    case OR:
+        position.first = compile(formula->getSubformula(), binders);
+        position.second = compile(formula->getSubformula2(), binders);
+        break;
+    case DIAMOND:
+    case BOX:
+        position.first = compile(formula->getSubformula(), binders);
+        position.label = m_system.getLabelIndex(formula->getVarLabel());
+        break;
+    case MU:
+    case NU: {
+        // The priority is at least that of the binders this fixpoint depends on, odd for mu and even for nu.
+        for (int binder : key.second) {
+            if (binder >= 0) {
+                position.priority = std::max(position.priority, m_positions[binder].priority);
+            }
+        }
+        if ((position.priority % 2 == 1) != (position.operation == MU)) {
+            ++position.priority;
+        }
+        m_maxPriority = std::max(m_maxPriority, position.priority);
+        m_positions[index].priority = position.priority;
+
+        std::map<std::string, int> bodyBinders = binders;
+        bodyBinders[formula->getVarLabel()] = index;
+        position.first = compile(formula->getSubformula(), bodyBinders);
+        break;
+    }
+    default:
+        break;
+    }
+
+    m_positions[index] = position;
+    return index;
+}
+
+int ParityGameReduction::getOwner(int position) const
+{
+    if (position < 0) {
+        return 0;
+    }
+
+    Op operation = m_positions[position].operation;
+    return (operation == AND || operation == BOX) ? 1 : 0;
+}
+
+int ParityGameReduction::getPriority(int position) const
+{
+    switch (position) {
+    case TRUE_POSITION:
+        return 0;
+    case FALSE_POSITION:
+        return 1;
+    default:
+        break;
+    }
+
+    Op operation = m_positions[position].operation;
+    return (operation == MU || operation == NU) ? m_positions[position].priority : m_maxPriority;
+}
+
+void ParityGameReduction::getSuccessors(int position, int state, std::vector<Configuration>& successors) const
+{
+    successors.clear();
+    if (position < 0) {
+        successors.emplace_back(position, 0);
+        return;
+    }
+
+    const Position& current = m_positions[position];
+    switch (current.operation) {
+    case AND:
+    case OR:
+        successors.emplace_back(current.first, state);
+        successors.emplace_back(current.second, state);
+        break;
+    case DIAMOND:
+    case BOX: {
+        StateRange toStates(nullptr, nullptr);
+        if (current.label >= 0) {
+            toStates = m_system.getToStates(state, current.label);
+        }
+
+        // Without successors, the diamond does not hold and the box does.
+        if (toStates.empty()) {
+            successors.emplace_back((current.operation == BOX) ? TRUE_POSITION : FALSE_POSITION, 0);
+        }
+        for (int toState : toStates) {
+            successors.emplace_back(current.first, toState);
+        }
+        break;
+    }
+    case MU:
+    case NU:
+        successors.emplace_back(current.first, state);
+        break;
+    default:
+        break;
+    }
+}
+
+size_t ParityGameReduction::getVertex(int position, int state) const
+{
+    if (position < 0) {
+        return (position == TRUE_POSITION) ? 0 : 1;
+    }
+    return 2 + (size_t)position * m_system.getNumStates() + state;
+}
+
+size_t ParityGameReduction::getNumVertices() const
+{
+    size_t numVertices = 2 + m_positions.size() * (size_t)m_system.getNumStates();
+    if (numVertices > UINT32_MAX) {
+        throw std::runtime_error("The parity game has " + std::to_string(numVertices) + " vertices, more than a Vertex can number");
+    }
+    return numVertices;
+}
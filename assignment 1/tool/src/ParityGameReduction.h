@@ -0,0 +1,128 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_PARITYGAMEREDUCTION_H_
+#define TOOL_PARITYGAMEREDUCTION_H_
+
+#include "LabelledTransitionSystem.h"
+#include "MuCalculus.h"
+#include "StateSet.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Checks a mu-calculus formula by solving the parity game of the system and the formula with the
+ * parity game solvers of assignment 2, without writing the game to a file.
+ *
+ * The formula is compiled into positions: a fixpoint variable refers to the position of its binder,
+ * and a subformula gets one position for every combination of binders of its free variables. The
+ * game has a vertex for every position and state, even moves at disjunctions, diamonds and fixpoints
+ * and odd at conjunctions and boxes. Every play that does not end in true or false passes a fixpoint
+ * infinitely often, the outermost of which decides the winner: least fixpoints have odd priorities,
+ * greatest fixpoints even ones, and a fixpoint has a higher priority than the binders of its free variables.
+ *
+ * The game can either be built for all states at once, or explored on the fly from a single state.
+ */
+class ParityGameReduction
+{
+public:
+    ParityGameReduction(LabelledTransitionSystem& system, MuFormula& formula);
+
+    /**
+     * Returns the set of states in which the formula holds. Throws std::runtime_error if the game
+     * has more vertices than a Vertex can number.
+     */
+    StateSet solve();
+
+    /**
+     * Returns whether the formula holds in the given state.
+     *
+     * Only the vertices reachable from the vertex of the state are explored, breadth first. A vertex
+     * is won by its owner once a successor is, and by the opponent once all its successors are, which
+     * is propagated to its predecessors right away. The exploration stops as soon as this decides the
+     * vertex of the state, and does not continue from vertices whose predecessors are all decided. The
+     * part of the game that is left undecided is solved once it is fully explored. Throws
+     * std::runtime_error if the game has more vertices than a Vertex can number.
+     */
+    bool holdsIn(int state);
+
+private:
+    /**
+     * The positions of true and false, the two vertices of the game that only loop to themselves.
+     */
+    enum { TRUE_POSITION = -1, FALSE_POSITION = -2 };
+
+    struct Position
+    {
+        Op operation;
+        int first;
+        int second;
+        int label;
+        int priority;
+    };
+
+    /**
+     * A subformula together with the positions of the binders of its free variables.
+     */
+    typedef std::pair<const MuFormula*, std::vector<int>> PositionKey;
+
+    /**
+     * A vertex of the game, as the position and the state.
+     */
+    typedef std::pair<int, int> Configuration;
+
+    /**
+     * Returns the position of formula, where binders maps the variables to the positions of their binders.
+     */
+    int compile(MuFormula* formula, const std::map<std::string, int>& binders);
+
+    /**
+     * Returns the player that moves at the position, 0 for even and 1 for odd.
+     */
+    int getOwner(int position) const;
+
+    /**
+     * Returns the priority of the vertices at the position.
+     */
+    int getPriority(int position) const;
+
+    /**
+     * Stores the successors of the state at the given position in successors.
+     */
+    void getSuccessors(int position, int state, std::vector<Configuration>& successors) const;
+
+    /**
+     * Returns the vertex of the game for the state at the given position.
+     */
+    size_t getVertex(int position, int state) const;
+
+    /**
+     * Returns the number of vertices of the game, throws std::runtime_error if it exceeds UINT32_MAX
+     * as vertices are 32-bit.
+     */
+    size_t getNumVertices() const;
+
+    LabelledTransitionSystem& m_system;
+    std::vector<Position> m_positions;
+    std::map<PositionKey, int> m_compiled;
+    int m_root;
+    int m_maxPriority;
+};
+
+#endif // TOOL_PARITYGAMEREDUCTION_H_
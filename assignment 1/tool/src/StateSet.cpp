@@ -0,0 +1,215 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StateSet.h"
+
+#include <assert.h>
+#include <utility>
+
+/**
+ * Returns the index of the lowest set bit, word must be non-zero.
+ */
+static int lowestBit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/**
+ * Returns the number of set bits in the word.
+ */
+static int bitCount(uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word != 0) {
+        word &= word - 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+StateSet::const_iterator::const_iterator(const StateSet& set, int state) :
+    m_set(set),
+    m_state(state)
+{}
+
+StateSet::const_iterator& StateSet::const_iterator::operator++()
+{
+    m_state = m_set.findNext(m_state + 1);
+    return *this;
+}
+
+StateSet::StateSet() :
+    m_numStates(0)
+{}
+
+StateSet::StateSet(int numStates, bool full) :
+    m_numStates(numStates),
+    m_words((numStates + 63) / 64, full ? ~uint64_t(0) : 0)
+{
+    clearPadding();
+}
+
+void StateSet::clear()
+{
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        m_words[i] = 0;
+    }
+}
+
+void StateSet::fill()
+{
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        m_words[i] = ~uint64_t(0);
+    }
+    clearPadding();
+}
+
+void StateSet::complement()
+{
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        m_words[i] = ~m_words[i];
+    }
+    clearPadding();
+}
+
+bool StateSet::empty() const
+{
+    uint64_t any = 0;
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        any |= m_words[i];
+    }
+    return any == 0;
+}
+
+size_t StateSet::count() const
+{
+    size_t result = 0;
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        result += bitCount(m_words[i]);
+    }
+    return result;
+}
+
+StateSet& StateSet::operator&=(const StateSet& other)
+{
+    assert(m_numStates == other.m_numStates);
+
+    uint64_t* words = m_words.data();
+    const uint64_t* otherWords = other.m_words.data();
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        words[i] &= otherWords[i];
+    }
+    return *this;
+}
+
+StateSet& StateSet::operator|=(const StateSet& other)
+{
+    assert(m_numStates == other.m_numStates);
+
+    uint64_t* words = m_words.data();
+    const uint64_t* otherWords = other.m_words.data();
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        words[i] |= otherWords[i];
+    }
+    return *this;
+}
+
+void StateSet::getChanges(const StateSet& other, std::vector<int>& added, std::vector<int>& removed) const
+{
+    assert(m_numStates == other.m_numStates);
+
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        uint64_t difference = m_words[i] ^ other.m_words[i];
+        while (difference != 0) {
+            int state = (int)(i * 64) + lowestBit(difference);
+            if (other.contains(state)) {
+                added.push_back(state);
+            }
+            else {
+                removed.push_back(state);
+            }
+            difference &= difference - 1;
+        }
+    }
+}
+
+void StateSet::swap(StateSet& other)
+{
+    std::swap(m_numStates, other.m_numStates);
+    m_words.swap(other.m_words);
+}
+
+bool StateSet::operator==(const StateSet& other) const
+{
+    if (m_numStates != other.m_numStates) {
+        return false;
+    }
+
+    // Accumulate the differences instead of branching on every word.
+    uint64_t difference = 0;
+    for (size_t i = 0; i < m_words.size(); ++i) {
+        difference |= m_words[i] ^ other.m_words[i];
+    }
+    return difference == 0;
+}
+
+StateSet::const_iterator StateSet::begin() const
+{
+    return const_iterator(*this, findNext(0));
+}
+
+StateSet::const_iterator StateSet::end() const
+{
+    return const_iterator(*this, m_numStates);
+}
+
+int StateSet::findNext(int state) const
+{
+    if (state >= m_numStates) {
+        return m_numStates;
+    }
+
+    size_t index = state >> 6;
+    uint64_t word = m_words[index] & (~uint64_t(0) << (state & 63));
+    while (word == 0) {
+        if (++index == m_words.size()) {
+            return m_numStates;
+        }
+        word = m_words[index];
+    }
+
+    return (int)(index * 64) + lowestBit(word);
+}
+
+void StateSet::clearPadding()
+{
+    if (m_numStates % 64 != 0) {
+        m_words.back() &= (uint64_t(1) << (m_numStates % 64)) - 1;
+    }
+}
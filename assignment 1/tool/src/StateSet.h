@@ -0,0 +1,157 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_STATESET_H_
+#define TOOL_STATESET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * A set of states of a labelled transition system with states 0 up to numStates, stored as a
+ * dense bitset of 64-bit words. All bits beyond numStates in the last word are kept zero, such
+ * that the set operations and comparisons can work on whole words.
+ */
+class StateSet
+{
+public:
+    /**
+     * Iterates over the states contained in the set in increasing order.
+     */
+    class const_iterator
+    {
+    public:
+        const_iterator(const StateSet& set, int state);
+
+        int operator*() const { return m_state; }
+        const_iterator& operator++();
+
+        bool operator==(const const_iterator& other) const { return m_state == other.m_state; }
+        bool operator!=(const const_iterator& other) const { return m_state != other.m_state; }
+
+    private:
+        const StateSet& m_set;
+        int m_state;
+    };
+
+    /**
+     * Constructs an empty set over zero states.
+     */
+    StateSet();
+
+    /**
+     * Constructs a set over numStates states, which is either empty or contains all states.
+     */
+    explicit StateSet(int numStates, bool full = false);
+
+    /**
+     * Returns the number of states this set ranges over.
+     */
+    int getNumStates() const { return m_numStates; }
+
+    /**
+     * Returns whether the given state is in the set.
+     */
+    bool contains(int state) const
+    {
+        return (m_words[state >> 6] >> (state & 63)) & 1;
+    }
+
+    /**
+     * Adds the state to the set.
+     */
+    void insert(int state)
+    {
+        m_words[state >> 6] |= uint64_t(1) << (state & 63);
+    }
+
+    /**
+     * Removes the state from the set.
+     */
+    void erase(int state)
+    {
+        m_words[state >> 6] &= ~(uint64_t(1) << (state & 63));
+    }
+
+    /**
+     * Removes all states from the set.
+     */
+    void clear();
+
+    /**
+     * Adds all states to the set.
+     */
+    void fill();
+
+    /**
+     * Replaces the set by its complement.
+     */
+    void complement();
+
+    /**
+     * Returns whether no state is in the set.
+     */
+    bool empty() const;
+
+    /**
+     * Returns the number of states in the set.
+     */
+    size_t count() const;
+
+    /**
+     * Intersects this set with other, both must range over the same number of states.
+     */
+    StateSet& operator&=(const StateSet& other);
+
+    /**
+     * Unites this set with other, both must range over the same number of states.
+     */
+    StateSet& operator|=(const StateSet& other);
+
+    /**
+     * Appends the states that are in other but not in this set to added, and the states that are
+     * in this set but not in other to removed.
+     */
+    void getChanges(const StateSet& other, std::vector<int>& added, std::vector<int>& removed) const;
+
+    /**
+     * Exchanges the contents of this set with other without copying.
+     */
+    void swap(StateSet& other);
+
+    bool operator==(const StateSet& other) const;
+    bool operator!=(const StateSet& other) const { return !(*this == other); }
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    /**
+     * Returns the first state in the set that is at least state, or m_numStates if there is none.
+     */
+    int findNext(int state) const;
+
+    /**
+     * Clears the unused bits of the last word.
+     */
+    void clearPadding();
+
+    int m_numStates;
+    std::vector<uint64_t> m_words;
+};
+
+#endif // TOOL_STATESET_H_
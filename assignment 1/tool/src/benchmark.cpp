@@ -0,0 +1,255 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "BenchmarkHarness.h"
+#include "FormulaProgram.h"
+#include "IncrementalEvaluator.h"
+#include "LabelledTransitionSystem.h"
+#include "MuCalculus.h"
+#include "ParityGameReduction.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * A formula of a testcase family checked on an LTS.
+ *
+ * @expected is the verdict in the verdicts.txt of the family, 1 if the formula holds, 0 if it does
+ * not and -1 if the family has no verdict for it.
+ */
+struct Instance {
+    std::string family;
+    std::string lts;
+    std::string formula;
+    int expected;
+};
+
+/**
+ * Returns the verdict of every formula of a family from its verdicts.txt, -1 when there is none.
+ *
+ * The file either lists "processing testcase <file>" followed by "verdict: <true|false>", or has
+ * a line per formula in the order of the formula files that ends in ": <true|false>".
+ */
+static std::vector<int> readVerdicts(const std::string& path, const std::vector<std::string>& formulas)
+{
+    std::vector<int> verdicts(formulas.size(), -1);
+    std::ifstream file(path + "/verdicts.txt");
+    if (!file) {
+        return verdicts;
+    }
+
+    auto parseVerdict = [](std::string text) {
+        text.erase(0, text.find_first_not_of(" \t\r"));
+        text.erase(text.find_last_not_of(" \t\r") + 1);
+        return (text == "true") ? 1 : (text == "false") ? 0 : -1;
+    };
+
+    std::vector<std::string> lines;
+    std::string line;
+    bool named = false;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+        named = named || line.find("processing testcase") != std::string::npos;
+    }
+
+    if (named) {
+        std::string current;
+        for (auto& text : lines) {
+            if (text.find("processing testcase") != std::string::npos) {
+                current = text.substr(text.find("testcase") + 8);
+                current.erase(0, current.find_first_not_of(" \t"));
+                current.erase(current.find_last_not_of(" \t\r") + 1);
+            }
+            else if (text.compare(0, 8, "verdict:") == 0) {
+                auto formula = std::find(formulas.begin(), formulas.end(), current);
+                if (formula != formulas.end()) {
+                    verdicts[formula - formulas.begin()] = parseVerdict(text.substr(8));
+                }
+            }
+        }
+    }
+    else {
+        size_t index = 0;
+        for (auto& text : lines) {
+            size_t separator = text.rfind(':');
+            if (separator != std::string::npos && index < formulas.size()) {
+                verdicts[index++] = parseVerdict(text.substr(separator + 1));
+            }
+        }
+    }
+
+    return verdicts;
+}
+
+/**
+ * Collects every formula of every family in the testcases directory checked on every LTS of its
+ * family. A family without an LTS of its own is checked on fixpoints_only/test.aut, as runtests.sh
+ * does.
+ */
+static std::vector<Instance> collectInstances(const std::string& testcases, const std::vector<std::string>& families)
+{
+    std::vector<Instance> instances;
+    for (auto& family : listDirectory(testcases, true, "")) {
+        if (!families.empty() && std::find(families.begin(), families.end(), family) == families.end()) {
+            continue;
+        }
+
+        std::string path = testcases + "/" + family;
+        std::vector<std::string> formulas = listDirectory(path, false, ".mcf");
+        std::vector<std::string> systems = listDirectory(path, false, ".aut");
+        std::vector<int> verdicts = readVerdicts(path, formulas);
+
+        for (auto& name : systems) {
+            name = path + "/" + name;
+        }
+        if (systems.empty()) {
+            systems.push_back(testcases + "/fixpoints_only/test.aut");
+        }
+
+        for (auto& lts : systems) {
+            for (size_t formula = 0; formula < formulas.size(); ++formula) {
+                instances.push_back({ family, lts, path + "/" + formulas[formula], verdicts[formula] });
+            }
+        }
+    }
+
+    return instances;
+}
+
+/**
+ * Loads the LTS and checks the formula in the initial state with the given algorithm, which is one of
+ * naive, improved, incremental, paritygame and local.
+ */
+static TrialResult checkInstance(const Instance& instance, const std::string& algorithm, bool useCache)
+{
+    TrialResult result = { -1, -1, 0, 0, -1 };
+
+    auto start = std::chrono::steady_clock::now();
+    std::string cacheFilename = instance.lts + ".cache";
+    LabelledTransitionSystem system;
+    if (!useCache || !LabelledTransitionSystem::loadCache(cacheFilename.c_str(), instance.lts.c_str(), system)) {
+        if (!LabelledTransitionSystem::parseAldebaranFormat(instance.lts.c_str(), system)) {
+            return result;
+        }
+
+        if (useCache) {
+            system.writeCache(cacheFilename.c_str(), instance.lts.c_str());
+        }
+    }
+
+    MuFormula* formula = MuFormula::parseMuFormula(instance.formula.c_str());
+    if (formula == nullptr) {
+        return result;
+    }
+    auto loaded = std::chrono::steady_clock::now();
+
+    bool holds;
+    if (algorithm == "incremental") {
+        IncrementalEvaluator evaluator(system, *formula);
+        holds = evaluator.solve().contains(system.getInitialState());
+    }
+    else if (algorithm == "paritygame") {
+        ParityGameReduction reduction(system, *formula);
+        holds = reduction.solve().contains(system.getInitialState());
+    }
+    else if (algorithm == "local") {
+        ParityGameReduction reduction(system, *formula);
+        holds = reduction.holdsIn(system.getInitialState());
+    }
+    else {
+        FormulaProgram program(system, *formula, algorithm == "naive");
+        holds = program.solve().contains(system.getInitialState());
+        result.iterations = program.getIterations();
+    }
+    auto solved = std::chrono::steady_clock::now();
+
+    result.verdict = holds ? 1 : 0;
+    result.loadMilliseconds = std::chrono::duration<double, std::milli>(loaded - start).count();
+    result.solveMilliseconds = std::chrono::duration<double, std::milli>(solved - loaded).count();
+    return result;
+}
+
+/**
+ * Benchmarks the model checker on every testcase family, as in:
+ * benchmark [--algo=A]... [--family=F]... [--trials=N] [--warmup=N] [--timeout=S] [--format=csv|json] [--file=name] [--cache] <testcases directory>
+ */
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> algorithms;
+    BenchmarkOptions options;
+    bool useCache = false;
+    std::string testcases;
+
+    for (int argIndex = 1; argIndex < argc; ++argIndex) {
+        std::string argument = argv[argIndex];
+        std::string value = argument.substr(argument.find('=') + 1);
+
+        if (parseBenchmarkOption(argument, options)) {
+            continue;
+        }
+
+        if (argument.compare(0, 7, "--algo=") == 0) {
+            algorithms.push_back(value);
+        }
+        else if (argument == "--cache") {
+            useCache = true;
+        }
+        else {
+            testcases = argument;
+        }
+    }
+
+    for (auto& algorithm : algorithms) {
+        if (algorithm != "naive" && algorithm != "improved" && algorithm != "incremental" && algorithm != "paritygame" && algorithm != "local") {
+            testcases.clear();
+        }
+    }
+
+    if (testcases.empty()) {
+        std::cout << "Usage: [--algo=naive|improved|incremental|paritygame|local]... [--family=<name>]... [--trials=N] [--warmup=N] [--timeout=S] "
+            "[--format=csv|json] [--file=<filename>] [--cache] <testcases directory>" << std::endl;
+        return -1;
+    }
+
+    if (algorithms.empty()) {
+        algorithms.push_back("improved");
+    }
+    while (testcases.size() > 1 && testcases.back() == '/') {
+        testcases.pop_back();
+    }
+
+    std::vector<Column> columns = { { "family", false }, { "lts", false }, { "formula", false }, { "algorithm", false } };
+
+    // Every instance is run by every algorithm before the next, so a failing verdict is reported early.
+    std::vector<BenchmarkRun> runs;
+    for (auto& instance : collectInstances(testcases, options.families)) {
+        for (auto& algorithm : algorithms) {
+            std::string lts = instance.lts.substr(testcases.size() + 1);
+            std::string formula = instance.formula.substr(testcases.size() + 1);
+
+            runs.push_back({ formula + " on " + lts + " using " + algorithm, { instance.family, lts, formula, algorithm },
+                instance.expected, std::bind(checkInstance, instance, algorithm, useCache) });
+        }
+    }
+
+    return runBenchmark(options, columns, runs, "verdict", { "false", "true" });
+}
@@ -14,66 +14,282 @@
  * limitations under the License.
  */
 
+#include "FormulaProgram.h"
+#include "IncrementalEvaluator.h"
 #include "LabelledTransitionSystem.h"
 #include "MuCalculus.h"
+#include "ParityGameReduction.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
 #include <iostream>
 #include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * The algorithms that can be used to evaluate a formula.
+ */
+enum Algorithm {
+    NAIVE,          // naive fixpoint iteration
+    EMERSON_LEI,    // fixpoint iteration that reuses approximations
+    INCREMENTAL,    // fixpoint iteration that propagates changes
+    PARITY_GAME,    // solving the parity game of the system and formula
+    LOCAL           // exploring the parity game from the initial state only
+};
+
+/**
+ * Returns whether the formula holds in the initial state of the system.
+ */
+static bool checkFormula(LabelledTransitionSystem& system, MuFormula& formula, Algorithm algorithm)
+{
+    if (algorithm == INCREMENTAL) {
+        IncrementalEvaluator evaluator(system, formula);
+        return evaluator.solve().contains(system.getInitialState());
+    }
+
+    if (algorithm == PARITY_GAME) {
+        ParityGameReduction reduction(system, formula);
+        return reduction.solve().contains(system.getInitialState());
+    }
+
+    if (algorithm == LOCAL) {
+        ParityGameReduction reduction(system, formula);
+        return reduction.holdsIn(system.getInitialState());
+    }
+
+    FormulaProgram program(system, formula, algorithm == NAIVE);
+    return program.solve().contains(system.getInitialState());
+}
+
+/**
+ * Adds the .mcf files in the directory strDirectory to filenames in alphabetical order, or
+ * strDirectory itself when it is not a directory.
+ */
+static void addFormulaFiles(const char* strDirectory, std::vector<std::string>& filenames)
+{
+#ifndef _WIN32
+    struct stat status;
+    DIR* directory = nullptr;
+    if (stat(strDirectory, &status) == 0 && S_ISDIR(status.st_mode)) {
+        directory = opendir(strDirectory);
+    }
+
+    if (directory != nullptr) {
+        std::vector<std::string> entries;
+        while (dirent* entry = readdir(directory)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".mcf") == 0) {
+                entries.push_back(std::string(strDirectory) + "/" + name);
+            }
+        }
+        closedir(directory);
+
+        std::sort(entries.begin(), entries.end());
+        filenames.insert(filenames.end(), entries.begin(), entries.end());
+        return;
+    }
+#endif
+
+    filenames.push_back(strDirectory);
+}
+
+/**
+ * The outcome of checking a single formula in batch mode.
+ */
+struct BatchResult {
+    bool parsed;
+    bool failed; // The formula was parsed but could not be checked.
+    bool holds;
+    double milliseconds;
+};
+
+/**
+ * Checks every formula against the system on numThreads threads, and prints a table with the
+ * verdict and time of every formula.
+ */
+static void runBatch(LabelledTransitionSystem& system, const std::vector<std::string>& filenames, Algorithm algorithm, unsigned int numThreads)
+{
+    std::vector<BatchResult> results(filenames.size());
+    std::atomic<size_t> nextFormula(0);
+
+    // The system is only read while solving, so all threads can share it.
+    auto worker = [&]() {
+        for (size_t index = nextFormula++; index < filenames.size(); index = nextFormula++) {
+            auto start = std::chrono::steady_clock::now();
+            BatchResult& result = results[index];
+
+            // A malformed formula is reported in the table instead of ending the batch.
+            MuFormula* formula = nullptr;
+            try {
+                formula = MuFormula::parseMuFormula(filenames[index].c_str());
+            }
+            catch (std::exception&) {
+                formula = nullptr;
+            }
+            result.parsed = (formula != nullptr);
+            result.failed = false;
+            result.holds = false;
+            try {
+                result.holds = result.parsed && checkFormula(system, *formula, algorithm);
+            }
+            catch (std::exception&) {
+                result.failed = true;
+            }
+            MuFormula::deleteMuFormula(formula);
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            result.milliseconds = elapsed.count();
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 1; thread < numThreads; ++thread) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - start;
+
+    // Print the verdict table.
+    size_t width = 7;
+    for (auto& filename : filenames) {
+        width = std::max(width, filename.size());
+    }
+
+    std::cout << std::left << std::setw(width + 2) << "formula" << std::setw(16) << "verdict" << "time (ms)" << std::endl;
+    for (size_t index = 0; index < filenames.size(); ++index) {
+        const BatchResult& result = results[index];
+        const char* verdict = !result.parsed ? "parse error" : result.failed ? "error" : (result.holds ? "holds" : "doesn't hold");
+        std::cout << std::left << std::setw(width + 2) << filenames[index] << std::setw(16) << verdict
+            << std::fixed << std::setprecision(3) << result.milliseconds << std::endl;
+    }
+
+    std::cout << "checked " << filenames.size() << " formulas in " << std::fixed << std::setprecision(3) << total.count() << " ms" << std::endl;
+}
 
  /**
   * The main entry point for the program.
   */
 int main(int argc, char* argv[])
 {
-    if (argc < 3) {
-        std::cout << "Usage: [--algo=naive|improved] <aldebaran filename> <mu-calculus filename>" << std::endl;
+    // Input that might or should be specified.
+    Algorithm algorithm = EMERSON_LEI;
+    bool useCache = false; // Reuse or write the binary cache of the LTS.
+    bool batch = false; // Check all given formulas in a single run.
+    unsigned int numThreads = 1; // The number of threads used in batch mode.
+    const char* ltsFilename = nullptr;
+    std::vector<std::string> mcfFilenames;
+
+    // The zeroed argument is the filename itself.
+    for (int argIndex = 1; argIndex < argc; ++argIndex) {
+        if (strncmp(argv[argIndex], "--", 2) == 0) {
+            // Check which algorithm was specified, otherwise default to improved.
+            if (strcmp(argv[argIndex], "--algo=naive") == 0) {
+                algorithm = NAIVE;
+            }
+            else if (strcmp(argv[argIndex], "--algo=incremental") == 0) {
+                algorithm = INCREMENTAL;
+            }
+            else if (strcmp(argv[argIndex], "--algo=paritygame") == 0) {
+                algorithm = PARITY_GAME;
+            }
+            else if (strcmp(argv[argIndex], "--algo=local") == 0) {
+                algorithm = LOCAL;
+            }
+            else if (strcmp(argv[argIndex], "--cache") == 0) {
+                useCache = true;
+            }
+            else if (strcmp(argv[argIndex], "--batch") == 0) {
+                batch = true;
+            }
+            else if (strncmp(argv[argIndex], "--threads=", 10) == 0) {
+                int threads = atoi(argv[argIndex] + 10);
+                numThreads = (threads > 0) ? threads : std::max(1u, std::thread::hardware_concurrency());
+            }
+        }
+        else if (ltsFilename == nullptr) {
+            ltsFilename = argv[argIndex];
+        }
+        else if (batch) {
+            addFormulaFiles(argv[argIndex], mcfFilenames);
+        }
+        else {
+            mcfFilenames.assign(1, argv[argIndex]);
+        }
+    }
+
+    if (ltsFilename == nullptr || mcfFilenames.empty()) {
+        std::cout << "Usage: [--algo=naive|improved|incremental|paritygame|local] [--cache] <aldebaran filename> <mu-calculus filename>" << std::endl;
+        std::cout << "       --batch [--threads=N] [--algo=naive|improved|incremental|paritygame|local] [--cache] <aldebaran filename> <mu-calculus filename or directory>..." << std::endl;
         std::cin.get(); return -1;
     }
 
-    int argumentIndex = 1; // The zeroed argument is the filename itself.
-    bool naiveAlgorithm = false; // Using the naive algorithm.
+    // With --cache, reuse the binary cache next to the LTS when it is up to date, otherwise parse the LTS and write the cache.
+    std::string cacheFilename = std::string(ltsFilename) + ".cache";
+
+    LabelledTransitionSystem system;
+    if (!useCache || !LabelledTransitionSystem::loadCache(cacheFilename.c_str(), ltsFilename, system)) {
+        if (!LabelledTransitionSystem::parseAldebaranFormat(ltsFilename, system)) {
+            std::cin.get(); return -1;
+        }
 
-    if (argc == 4) {
-        // Check which algorithm was specified, otherwise default to improved.
-        if (strcmp(argv[argumentIndex], "--algo=naive") == 0) {
-            naiveAlgorithm = true;
+        if (useCache) {
+            system.writeCache(cacheFilename.c_str(), ltsFilename);
         }
-        ++argumentIndex; // The first filename is actually the third argument.
     }
-    
-    // Parse the LTS file.
-    const char* ltsFilename = argv[argumentIndex++];
 
-    LabelledTransitionSystem system;
-    if (!LabelledTransitionSystem::parseAldebaranFormat(ltsFilename, system)) {
-        std::cin.get(); return -1;  
+    if (batch) {
+        runBatch(system, mcfFilenames, algorithm, numThreads);
+        return 0;
     }
         
     // Parse the mu-calculus file.
-    MuFormula* formula = MuFormula::parseMuFormula(argv[argumentIndex++]);
+    MuFormula* formula = MuFormula::parseMuFormula(mcfFilenames.front().c_str());
     if (formula != nullptr) {
         std::cout << "Solving " << formula->toString();
 
-        std::set<int> states; // The set of states in which the formula holds.
-
         // Evaluate the linear transition system with the given mu-calculus.
-        std::map<std::string, std::set<int>> variables;
-        if (!naiveAlgorithm) {
+        switch (algorithm) {
+        case NAIVE:
+            std::cout << " using the naive algorithm." << std::endl;
+            break;
+        case EMERSON_LEI:
             std::cout << " using emerson-lei." << std::endl;
+            break;
+        case INCREMENTAL:
+            std::cout << " using incremental evaluation." << std::endl;
+            break;
+        case PARITY_GAME:
+            std::cout << " using the parity game reduction." << std::endl;
+            break;
+        case LOCAL:
+            std::cout << " using local checking." << std::endl;
+            break;
+        }
 
-            // recursively set whether (sub-)formuli are closed
-            formula->setFormulaClosedness();
-
-            // initialize the variables map
-            formula->initVarMaps(system, variables);
+        bool holds;
+        try {
+            holds = checkFormula(system, *formula, algorithm);
         }
-        else {
-            std::cout << " using the naive algorithm." << std::endl;
+        catch (std::exception& exception) {
+            std::cout << exception.what() << std::endl;
+            return -1;
         }
 
-        states = formula->solve(system, variables, naiveAlgorithm);
-        
-        if (states.find(system.getInitialState()) == states.end()) {
+        if (!holds) {
             std::cout << "formula doesn't hold" << std::endl;
         }
         else {
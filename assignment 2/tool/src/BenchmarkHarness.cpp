@@ -0,0 +1,357 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "BenchmarkHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <stdlib.h>
+
+#include <dirent.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * The summary of all trials of a run, the times are in milliseconds.
+ */
+struct Measurement {
+    std::string status;
+    int verdict;
+    double load;
+    double solveMedian;
+    double solveP10;
+    double solveP90;
+    double totalMedian;
+    long peakRssKilobytes;
+    long long iterations;
+};
+
+BenchmarkOptions::BenchmarkOptions()
+    : trials(5), warmup(1), timeout(300), json(false)
+{
+}
+
+/**
+ * Returns whether the name of first comes before second, where runs of digits are compared by value
+ * such that dining_10 comes after dining_9.
+ */
+static bool naturalLess(const std::string& first, const std::string& second)
+{
+    size_t i = 0, j = 0;
+    while (i < first.size() && j < second.size()) {
+        if (isdigit(first[i]) && isdigit(second[j])) {
+            size_t endFirst = first.find_first_not_of("0123456789", i);
+            size_t endSecond = second.find_first_not_of("0123456789", j);
+            unsigned long long a = std::stoull(first.substr(i, endFirst - i));
+            unsigned long long b = std::stoull(second.substr(j, endSecond - j));
+            if (a != b) {
+                return a < b;
+            }
+            i = std::min(endFirst, first.size());
+            j = std::min(endSecond, second.size());
+        }
+        else if (first[i] != second[j]) {
+            return first[i] < second[j];
+        }
+        else {
+            ++i;
+            ++j;
+        }
+    }
+    return first.size() - i < second.size() - j;
+}
+
+std::vector<std::string> listDirectory(const std::string& path, bool directories, const std::string& suffix)
+{
+    std::vector<std::string> names;
+    DIR* directory = opendir(path.c_str());
+    if (directory == nullptr) {
+        return names;
+    }
+
+    while (dirent* entry = readdir(directory)) {
+        std::string name = entry->d_name;
+        struct stat status;
+        if (name[0] == '.' || stat((path + "/" + name).c_str(), &status) != 0) {
+            continue;
+        }
+
+        if (directories ? S_ISDIR(status.st_mode)
+            : (S_ISREG(status.st_mode) && name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)) {
+            names.push_back(name);
+        }
+    }
+    closedir(directory);
+
+    std::sort(names.begin(), names.end(), naturalLess);
+    return names;
+}
+
+bool parseBenchmarkOption(const std::string& argument, BenchmarkOptions& options)
+{
+    std::string value = argument.substr(argument.find('=') + 1);
+
+    if (argument.compare(0, 9, "--family=") == 0) {
+        options.families.push_back(value);
+    }
+    else if (argument.compare(0, 9, "--trials=") == 0) {
+        options.trials = std::max(1, atoi(value.c_str()));
+    }
+    else if (argument.compare(0, 9, "--warmup=") == 0) {
+        options.warmup = std::max(0, atoi(value.c_str()));
+    }
+    else if (argument.compare(0, 10, "--timeout=") == 0) {
+        options.timeout = std::max(0, atoi(value.c_str()));
+    }
+    else if (argument.compare(0, 9, "--format=") == 0) {
+        options.json = (value == "json");
+    }
+    else if (argument.compare(0, 7, "--file=") == 0) {
+        options.outputFilename = value;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Runs the trial in a child process, such that every trial has its own peak resident set size.
+ * Returns an empty string on success, and otherwise why the trial failed.
+ */
+static std::string runTrial(const Trial& trial, unsigned timeout, TrialResult& result, long& peakRssKilobytes)
+{
+    int channel[2];
+    if (pipe(channel) != 0) {
+        return "error";
+    }
+
+    std::cout.flush();
+    pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return "error";
+    }
+
+    if (child == 0) {
+        // Whatever the trial prints is dropped, as stdout holds the results of the benchmark.
+        close(channel[0]);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        alarm(timeout);
+
+        TrialResult measured = { -1, -1, 0, 0, -1 };
+        try {
+            measured = trial();
+        }
+        catch (std::exception& exception) {
+            std::cerr << exception.what() << "\n";
+        }
+        ssize_t written = write(channel[1], &measured, sizeof(measured));
+        _exit(written == sizeof(measured) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    ssize_t received = read(channel[0], &result, sizeof(result));
+    close(channel[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child) {
+        return "error";
+    }
+    peakRssKilobytes = usage.ru_maxrss;
+
+    if (WIFSIGNALED(status)) {
+        return (WTERMSIG(status) == SIGALRM) ? "timeout" : "crashed";
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != sizeof(result)) {
+        return "error";
+    }
+    return (result.verdict < 0) ? "unreadable" : "";
+}
+
+/**
+ * Returns the percentile of the sorted values, taking the nearest rank.
+ */
+static double percentile(const std::vector<double>& sorted, double percent)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = (size_t)std::ceil(percent / 100 * sorted.size());
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+/**
+ * Runs the warmup untimed and the timed trials of the run, and summarises them.
+ */
+static Measurement measure(const BenchmarkRun& run, const BenchmarkOptions& options)
+{
+    Measurement measurement = { "", -1, 0, 0, 0, 0, 0, 0, -1 };
+    std::vector<double> load, solve, total;
+    bool detailsMatch = true;
+
+    for (unsigned trial = 0; trial < options.warmup + options.trials; ++trial) {
+        TrialResult result;
+        long peakRssKilobytes = 0;
+        std::string failure = runTrial(run.trial, options.timeout, result, peakRssKilobytes);
+        if (!failure.empty()) {
+            measurement.status = failure;
+            return measurement;
+        }
+
+        if (trial < options.warmup) {
+            continue;
+        }
+
+        measurement.verdict = result.verdict;
+        measurement.iterations = result.iterations;
+        measurement.peakRssKilobytes = std::max(measurement.peakRssKilobytes, peakRssKilobytes);
+        detailsMatch = detailsMatch && result.detailsMatch != 0;
+        load.push_back(result.loadMilliseconds);
+        solve.push_back(result.solveMilliseconds);
+        total.push_back(result.loadMilliseconds + result.solveMilliseconds);
+    }
+
+    std::sort(load.begin(), load.end());
+    std::sort(solve.begin(), solve.end());
+    std::sort(total.begin(), total.end());
+    measurement.load = percentile(load, 50);
+    measurement.solveMedian = percentile(solve, 50);
+    measurement.solveP10 = percentile(solve, 10);
+    measurement.solveP90 = percentile(solve, 90);
+    measurement.totalMedian = percentile(total, 50);
+
+    if (run.expected < 0) {
+        measurement.status = "unchecked";
+    }
+    else {
+        measurement.status = (measurement.verdict == run.expected && detailsMatch) ? "ok" : "mismatch";
+    }
+    return measurement;
+}
+
+/**
+ * Returns the text quoted as a JSON string.
+ */
+static std::string quote(const std::string& text)
+{
+    std::string result = "\"";
+    for (char character : text) {
+        if (character == '"' || character == '\\') {
+            result += '\\';
+        }
+        result += character;
+    }
+    return result + "\"";
+}
+
+/**
+ * Writes a measurement as a CSV line or a JSON object, preceded by the values of the columns.
+ */
+static void writeMeasurement(std::ostream& output, const BenchmarkOptions& options, const std::vector<Column>& columns,
+    const BenchmarkRun& run, const std::string& verdictColumn, const std::vector<std::string>& verdictNames, const Measurement& measurement)
+{
+    auto verdictName = [&](int verdict) {
+        return (verdict >= 0 && (size_t)verdict < verdictNames.size()) ? verdictNames[verdict] : std::string();
+    };
+    std::string iterations = (measurement.iterations >= 0) ? std::to_string(measurement.iterations) : "";
+
+    output << std::fixed << std::setprecision(3);
+    if (options.json) {
+        output << "{";
+        for (size_t column = 0; column < columns.size(); ++column) {
+            const std::string& value = run.values[column];
+            output << quote(columns[column].name) << ": " << (columns[column].number ? value : quote(value)) << ", ";
+        }
+        output << "\"trials\": " << options.trials << ", \"expected\": " << quote(verdictName(run.expected))
+            << ", " << quote(verdictColumn) << ": " << quote(verdictName(measurement.verdict))
+            << ", \"status\": " << quote(measurement.status) << ", \"load_ms\": " << measurement.load
+            << ", \"solve_ms_median\": " << measurement.solveMedian << ", \"solve_ms_p10\": " << measurement.solveP10
+            << ", \"solve_ms_p90\": " << measurement.solveP90 << ", \"total_ms_median\": " << measurement.totalMedian
+            << ", \"peak_rss_kb\": " << measurement.peakRssKilobytes << ", \"iterations\": " << (iterations.empty() ? "null" : iterations) << "}";
+    }
+    else {
+        for (auto& value : run.values) {
+            output << value << ",";
+        }
+        output << options.trials << "," << verdictName(run.expected) << "," << verdictName(measurement.verdict) << "," << measurement.status << ","
+            << measurement.load << "," << measurement.solveMedian << "," << measurement.solveP10 << "," << measurement.solveP90 << ","
+            << measurement.totalMedian << "," << measurement.peakRssKilobytes << "," << iterations << "\n";
+    }
+}
+
+int runBenchmark(const BenchmarkOptions& options, const std::vector<Column>& columns, const std::vector<BenchmarkRun>& runs,
+    const std::string& verdictColumn, const std::vector<std::string>& verdictNames)
+{
+    std::ofstream file;
+    if (!options.outputFilename.empty()) {
+        file.open(options.outputFilename);
+        if (!file) {
+            std::cerr << "Failed to open file " << options.outputFilename << "\n";
+            return -1;
+        }
+    }
+    std::ostream& output = options.outputFilename.empty() ? std::cout : file;
+
+    if (options.json) {
+        output << "[\n";
+    }
+    else {
+        for (auto& column : columns) {
+            output << column.name << ",";
+        }
+        output << "trials,expected," << verdictColumn << ",status,load_ms,solve_ms_median,solve_ms_p10,solve_ms_p90,"
+            "total_ms_median,peak_rss_kb,iterations\n";
+    }
+
+    int failures = 0;
+    bool first = true;
+    for (auto& run : runs) {
+        std::cerr << run.description << "\n";
+
+        Measurement measurement = measure(run, options);
+        if (measurement.status != "ok" && measurement.status != "unchecked") {
+            std::cerr << "  " << measurement.status << "\n";
+            ++failures;
+        }
+
+        if (options.json && !first) {
+            output << ",\n";
+        }
+        writeMeasurement(output, options, columns, run, verdictColumn, verdictNames, measurement);
+        output.flush();
+        first = false;
+    }
+
+    if (options.json) {
+        output << "\n]\n";
+    }
+
+    std::cerr << runs.size() << " runs, " << failures << " failed\n";
+    return (failures == 0) ? 0 : 1;
+}
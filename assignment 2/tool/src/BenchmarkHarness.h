@@ -0,0 +1,107 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_BENCHMARKHARNESS_H_
+#define TOOL_BENCHMARKHARNESS_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * The measurements of a single trial, sent from the process that ran it.
+ *
+ * @verdict is the index of the computed answer in the verdict names, or -1 if the input could not
+ * be read.
+ * @detailsMatch is 1 if everything else listed in the verdicts was computed as listed, 0 if not and
+ * -1 if it was not checked.
+ * @iterations is the number of iterations of the algorithm, or -1 if it does not count them.
+ */
+struct TrialResult {
+    int verdict;
+    int detailsMatch;
+    double loadMilliseconds;
+    double solveMilliseconds;
+    long long iterations;
+};
+
+/**
+ * A single trial, which loads the input and solves it. It runs in a child process and may throw.
+ */
+typedef std::function<TrialResult()> Trial;
+
+/**
+ * A column that identifies a run in the output, its values are written as JSON strings unless they
+ * are numbers.
+ */
+struct Column {
+    std::string name;
+    bool number;
+};
+
+/**
+ * A run of the benchmark, which repeats a trial and compares its verdict to the expected one.
+ *
+ * @description is printed before the run, and @values are those of the columns that start its line
+ * of the output. @expected is the index of the expected verdict, or -1 if there is none.
+ */
+struct BenchmarkRun {
+    std::string description;
+    std::vector<std::string> values;
+    int expected;
+    Trial trial;
+};
+
+/**
+ * The options that every benchmark takes.
+ *
+ * @trials is the number of timed trials of every run, preceded by @warmup untimed ones.
+ * @timeout is the limit of a trial in seconds, 0 for no limit.
+ * @outputFilename is where the results are written, the standard output if it is empty.
+ */
+struct BenchmarkOptions {
+    BenchmarkOptions();
+
+    std::vector<std::string> families;
+    unsigned trials;
+    unsigned warmup;
+    unsigned timeout;
+    bool json;
+    std::string outputFilename;
+};
+
+/**
+ * Returns the names of the entries of the directory in natural order, only the subdirectories if
+ * directories is set and otherwise only the files ending in suffix.
+ */
+std::vector<std::string> listDirectory(const std::string& path, bool directories, const std::string& suffix);
+
+/**
+ * Reads the argument into the options if it is one of --family=, --trials=, --warmup=, --timeout=,
+ * --format=csv|json and --file=, and returns whether it was.
+ */
+bool parseBenchmarkOption(const std::string& argument, BenchmarkOptions& options);
+
+/**
+ * Runs every run in its own child processes and writes a CSV line or JSON object per run, with the
+ * values of the columns followed by the trials, the expected and computed verdict under verdictColumn,
+ * the status and the times in milliseconds, peak memory and iterations. Returns 0 if every run was
+ * ok or unchecked, 1 if any failed and -1 if the output could not be opened.
+ */
+int runBenchmark(const BenchmarkOptions& options, const std::vector<Column>& columns, const std::vector<BenchmarkRun>& runs,
+    const std::string& verdictColumn, const std::vector<std::string>& verdictNames);
+
+#endif // TOOL_BENCHMARKHARNESS_H_
@@ -0,0 +1,210 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LiftingStrategy.h"
+
+#include "Preprocessing.h"
+
+#include <algorithm>
+#include <queue>
+#include <random>
+
+/**
+ * Returns the vertices in the order of the game.
+ */
+static std::vector<Vertex> createInputOrder(const ParityGame& game)
+{
+    std::vector<Vertex> order(game.getNumberOfVertices());
+    for (Vertex vertex = 0; vertex < order.size(); ++vertex) {
+        order[vertex] = vertex;
+    }
+    return order;
+}
+
+/**
+ * Returns the vertices with the most predecessors first, in the order of the game otherwise.
+ */
+static std::vector<Vertex> createIndegreeOrder(const ParityGame& game)
+{
+    std::vector<Vertex> order = createInputOrder(game);
+    std::stable_sort(order.begin(), order.end(), [&game](Vertex first, Vertex second) {
+        return game.getIncomingVertices(first).size() > game.getIncomingVertices(second).size();
+    });
+    return order;
+}
+
+/**
+ * Returns the vertices in the order a breadth-first search over the predecessors visits them,
+ * starting a new search from the first unvisited vertex of roots until every vertex is visited.
+ *
+ * A vertex is marked visited when it is taken from the queue, a vertex that was queued more than
+ * once is skipped after its first visit.
+ */
+static std::vector<Vertex> createBreadthFirstOrder(const ParityGame& game, const std::vector<Vertex>& roots)
+{
+    std::vector<Vertex> order;
+    order.reserve(game.getNumberOfVertices());
+    std::vector<bool> visited(game.getNumberOfVertices(), false);
+    std::queue<Vertex> workQueue;
+
+    for (auto root : roots) {
+        if (visited[root]) {
+            continue;
+        }
+
+        workQueue.push(root);
+        while (!workQueue.empty()) {
+            Vertex current = workQueue.front();
+            workQueue.pop();
+            if (visited[current]) {
+                continue;
+            }
+
+            visited[current] = true;
+            order.push_back(current);
+
+            for (auto incomingVertex : game.getIncomingVertices(current)) {
+                if (!visited[incomingVertex]) {
+                    workQueue.push(incomingVertex);
+                }
+            }
+        }
+    }
+
+    return order;
+}
+
+class InputStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        return createInputOrder(game);
+    }
+};
+
+class RandomStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        std::vector<Vertex> order = createInputOrder(game);
+        std::random_device rd;
+        std::default_random_engine engine(rd());
+        std::shuffle(order.begin(), order.end(), engine);
+        return order;
+    }
+};
+
+class IndegreeStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        return createIndegreeOrder(game);
+    }
+};
+
+class BreadthFirstStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        return createBreadthFirstOrder(game, createInputOrder(game));
+    }
+};
+
+class CombiStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        return createBreadthFirstOrder(game, createIndegreeOrder(game));
+    }
+};
+
+/**
+ * Only lifting a vertex with an odd priority can increase a measure from the minimal one, and the
+ * lower its priority the more significant the increase.
+ */
+class PriorityStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        std::vector<Vertex> order = createInputOrder(game);
+        std::stable_sort(order.begin(), order.end(), [&game](Vertex first, Vertex second) {
+            int firstPriority = game.getPriority(first);
+            int secondPriority = game.getPriority(second);
+            if (firstPriority % 2 != secondPriority % 2) {
+                return firstPriority % 2 == 1;
+            }
+            return firstPriority < secondPriority;
+        });
+        return order;
+    }
+};
+
+/**
+ * The measures of a component only depend on the components below it, so those are lifted first.
+ */
+class ReverseTopologicalStrategy : public LiftingStrategy {
+public:
+    std::vector<Vertex> getInitialOrder(const ParityGame& game) const override
+    {
+        std::vector<Vertex> order;
+        order.reserve(game.getNumberOfVertices());
+        for (const auto& component : decomposeComponents(game)) {
+            order.insert(order.end(), component.begin(), component.end());
+        }
+        return order;
+    }
+};
+
+/**
+ * Keeps lifting around the vertices that changed last, instead of going over the whole queue.
+ */
+class FocusStrategy : public InputStrategy {
+public:
+    bool liftFirst(const ParityGame& /*game*/, Vertex /*lifted*/, Vertex /*predecessor*/) const override
+    {
+        return true;
+    }
+};
+
+std::unique_ptr<LiftingStrategy> createLiftingStrategy(const std::string& name)
+{
+    std::unique_ptr<LiftingStrategy> strategy;
+    if (name == "input") {
+        strategy.reset(new InputStrategy());
+    }
+    else if (name == "random") {
+        strategy.reset(new RandomStrategy());
+    }
+    else if (name == "indegree") {
+        strategy.reset(new IndegreeStrategy());
+    }
+    else if (name == "breadthfirst") {
+        strategy.reset(new BreadthFirstStrategy());
+    }
+    else if (name == "combi") {
+        strategy.reset(new CombiStrategy());
+    }
+    else if (name == "priority") {
+        strategy.reset(new PriorityStrategy());
+    }
+    else if (name == "reverse-topological") {
+        strategy.reset(new ReverseTopologicalStrategy());
+    }
+    else if (name == "focus") {
+        strategy.reset(new FocusStrategy());
+    }
+    return strategy;
+}
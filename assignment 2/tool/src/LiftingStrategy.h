@@ -0,0 +1,63 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_LIFTINGSTRATEGY_H_
+#define TOOL_LIFTINGSTRATEGY_H_
+
+#include "ParityGame.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Decides the order in which small progress measures lifts the vertices.
+ *
+ * The solver starts with the vertices in the initial order, and queues the predecessors of a lifted
+ * vertex again. A strategy can move those to the front of the queue, to keep lifting the part of the
+ * game that changed last. The strategy is shared by all threads solving at the same time.
+ */
+class LiftingStrategy {
+public:
+    virtual ~LiftingStrategy() {}
+
+    /**
+     * Returns every vertex of the game once, in the order they are lifted initially.
+     */
+    virtual std::vector<Vertex> getInitialOrder(const ParityGame& game) const = 0;
+
+    /**
+     * Returns whether predecessor, queued again because lifted was lifted, is lifted before the
+     * vertices already queued.
+     */
+    virtual bool liftFirst(const ParityGame& /*game*/, Vertex /*lifted*/, Vertex /*predecessor*/) const { return false; }
+};
+
+/**
+ * Returns the strategy with the given name, or nullptr if there is none:
+ *
+ * - input, the vertices in the order of the game.
+ * - random, the vertices shuffled at random.
+ * - indegree, the vertices with the most predecessors first.
+ * - breadthfirst, a breadth-first search over the predecessors starting from the lowest unvisited vertex.
+ * - combi, like breadthfirst, but starting from the unvisited vertex with the most predecessors.
+ * - priority, the vertices with odd priorities first, the lowest priorities first within each parity.
+ * - reverse-topological, the strongly connected components without successors in other components first.
+ * - focus, like input, but the predecessors of a lifted vertex are lifted first.
+ */
+std::unique_ptr<LiftingStrategy> createLiftingStrategy(const std::string& name);
+
+#endif // TOOL_LIFTINGSTRATEGY_H_
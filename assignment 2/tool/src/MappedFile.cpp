@@ -0,0 +1,99 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.h"
+
+#include <assert.h>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() :
+    m_data(nullptr),
+    m_size(0),
+    m_mapped(false)
+{}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const char* strFilename)
+{
+    assert(strFilename != nullptr); // nullptr is not allowed.
+    close();
+
+#ifndef _WIN32
+    int descriptor = ::open(strFilename, O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        ::close(descriptor); return false;
+    }
+
+    m_size = (size_t)status.st_size;
+    if (m_size > 0) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(data);
+            m_mapped = true;
+        }
+    }
+
+    ::close(descriptor);
+    if (m_mapped || m_size == 0) {
+        return true;
+    }
+#endif
+
+    // Fall back to reading the whole file into memory.
+    std::ifstream file(strFilename, std::ios::binary | std::ios::ate);
+    if (file.fail()) {
+        return false;
+    }
+
+    m_buffer.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read(m_buffer.data(), m_buffer.size());
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return !file.fail();
+}
+
+void MappedFile::close()
+{
+#ifndef _WIN32
+    if (m_mapped) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+}
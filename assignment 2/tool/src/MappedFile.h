@@ -0,0 +1,68 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_MAPPEDFILE_H_
+#define TOOL_MAPPEDFILE_H_
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * Read-only view on the contents of a file. The file is mapped into memory where the platform
+ * supports it, and read into a buffer otherwise.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Maps the file specified by strFilename, returns false if it could not be opened.
+     */
+    bool open(const char* strFilename);
+
+    /**
+     * Unmaps the file, invalidating all pointers into its contents.
+     */
+    void close();
+
+    /**
+     * Returns the first character of the file.
+     */
+    const char* begin() const { return m_data; }
+
+    /**
+     * Returns one past the last character of the file.
+     */
+    const char* end() const { return m_data + m_size; }
+
+    /**
+     * Returns the size of the file in bytes.
+     */
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* m_data;
+    size_t m_size;
+    bool m_mapped;
+    std::vector<char> m_buffer;
+};
+
+#endif // TOOL_MAPPEDFILE_H_
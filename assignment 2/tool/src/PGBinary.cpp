@@ -0,0 +1,253 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PGBinary.h"
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string.h>
+
+/**
+ * The first section of a .pgb file.
+ */
+struct PgbHeader {
+    char magic[4];
+    uint32_t flags;
+    uint64_t numVertices;
+    uint64_t numEdges;
+};
+
+/**
+ * Returns size rounded up to a multiple of 8 bytes.
+ */
+static size_t padded(size_t size)
+{
+    return (size + 7) & ~size_t(7);
+}
+
+/**
+ * Reads consecutive values from the mapped file, checking that they lie within it.
+ */
+class SectionReader {
+public:
+    SectionReader(const MappedFile& file, const char* strFilename) :
+        m_cursor(file.begin()),
+        m_end(file.end()),
+        m_strFilename(strFilename)
+    {}
+
+    /**
+     * Copies count values of type T into values, and continues at the next multiple of 8 bytes.
+     */
+    template <typename T>
+    void read(T* values, size_t count)
+    {
+        size_t size = count * sizeof(T);
+        if (count > size_t(m_end - m_cursor) / sizeof(T)) {
+            throw std::runtime_error(std::string("File ") + m_strFilename + " is truncated");
+        }
+
+        memcpy(values, m_cursor, size);
+        m_cursor += std::min(padded(size), size_t(m_end - m_cursor));
+    }
+
+    /**
+     * Reads the offsets and vertices of one side of the edges, checking that they form valid rows
+     * that are only empty if allowEmpty is set.
+     */
+    void readRows(size_t numVertices, size_t numEdges, bool allowEmpty, std::vector<size_t>& offsets, std::vector<Vertex>& vertices)
+    {
+        std::vector<uint64_t> values(numVertices + 1);
+        read(values.data(), values.size());
+        vertices.resize(numEdges);
+        read(vertices.data(), vertices.size());
+
+        offsets.assign(values.begin(), values.end());
+        if (offsets[0] != 0 || offsets[numVertices] != numEdges) {
+            throw std::runtime_error(std::string("File ") + m_strFilename + " has inconsistent offsets");
+        }
+
+        for (size_t vertex = 0; vertex < numVertices; ++vertex) {
+            if (offsets[vertex] > offsets[vertex + 1]) {
+                throw std::runtime_error(std::string("File ") + m_strFilename + " has inconsistent offsets");
+            }
+            if (!allowEmpty && offsets[vertex] == offsets[vertex + 1]) {
+                throw std::runtime_error(std::string("File ") + m_strFilename + " has no successors for vertex " + std::to_string(vertex));
+            }
+
+            // The rows must be sorted without duplicates.
+            for (size_t index = offsets[vertex]; index < offsets[vertex + 1]; ++index) {
+                if (vertices[index] >= numVertices || (index > offsets[vertex] && vertices[index] <= vertices[index - 1])) {
+                    throw std::runtime_error(std::string("File ") + m_strFilename + " has invalid edges of vertex " + std::to_string(vertex));
+                }
+            }
+        }
+    }
+
+private:
+    const char* m_cursor;
+    const char* m_end;
+    const char* m_strFilename;
+};
+
+/**
+ * Returns whether the predecessor rows are exactly the transpose of the successor rows, given that
+ * both are sorted without duplicates and have the same number of edges.
+ */
+static bool isTranspose(const std::vector<size_t>& successorOffsets, const std::vector<Vertex>& successors,
+    const std::vector<size_t>& predecessorOffsets, const std::vector<Vertex>& predecessors)
+{
+    // Visiting the sources in increasing order must fill every predecessor row from its start.
+    std::vector<size_t> next(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+    for (size_t source = 0; source + 1 < successorOffsets.size(); ++source) {
+        for (size_t index = successorOffsets[source]; index < successorOffsets[source + 1]; ++index) {
+            Vertex target = successors[index];
+            if (next[target] == predecessorOffsets[target + 1] || predecessors[next[target]] != source) {
+                return false;
+            }
+            ++next[target];
+        }
+    }
+    return true;
+}
+
+ParityGame readBinaryParityGame(const char* pgbFilename)
+{
+    MappedFile file;
+    if (!file.open(pgbFilename)) {
+        throw std::runtime_error(std::string("Failed to open file ") + pgbFilename);
+    }
+
+    SectionReader reader(file, pgbFilename);
+    PgbHeader header;
+    reader.read(&header, 1);
+    if (memcmp(header.magic, "PGB1", 4) != 0) {
+        throw std::runtime_error(std::string("File ") + pgbFilename + " is not in .pgb format");
+    }
+
+    size_t numVertices = header.numVertices;
+    size_t numEdges = header.numEdges;
+    if (numVertices > UINT32_MAX || numVertices > file.size() || numEdges > file.size()) {
+        throw std::runtime_error(std::string("File ") + pgbFilename + " is truncated");
+    }
+    if (numVertices == 0) {
+        throw std::runtime_error(std::string("File ") + pgbFilename + " has no vertices");
+    }
+
+    std::vector<uint8_t> ownerBits((numVertices + 7) / 8);
+    reader.read(ownerBits.data(), ownerBits.size());
+    std::vector<int> owner(numVertices);
+    for (size_t vertex = 0; vertex < numVertices; ++vertex) {
+        owner[vertex] = (ownerBits[vertex / 8] >> (vertex % 8)) & 1;
+    }
+
+    std::vector<int32_t> priorities(numVertices);
+    reader.read(priorities.data(), priorities.size());
+    std::vector<int> priority(priorities.begin(), priorities.end());
+    for (auto value : priority) {
+        if (value < 0) {
+            throw std::runtime_error(std::string("File ") + pgbFilename + " has a negative priority");
+        }
+    }
+
+    std::vector<size_t> successorOffsets;
+    std::vector<Vertex> successors;
+    reader.readRows(numVertices, numEdges, false, successorOffsets, successors);
+
+    std::vector<size_t> predecessorOffsets;
+    std::vector<Vertex> predecessors;
+    if (header.flags & PGB_PREDECESSORS) {
+        reader.readRows(numVertices, numEdges, true, predecessorOffsets, predecessors);
+        if (!isTranspose(successorOffsets, successors, predecessorOffsets, predecessors)) {
+            throw std::runtime_error(std::string("File ") + pgbFilename + " has predecessors that do not match its successors");
+        }
+    }
+
+    return ParityGame(std::move(owner), std::move(priority), std::move(successorOffsets), std::move(successors),
+        std::move(predecessorOffsets), std::move(predecessors));
+}
+
+/**
+ * Writes count values of type T, padded with zeroes to a multiple of 8 bytes.
+ */
+template <typename T>
+static void writeSection(std::ofstream& file, const T* values, size_t count)
+{
+    const char zeroes[8] = {};
+    file.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+    file.write(zeroes, padded(count * sizeof(T)) - count * sizeof(T));
+}
+
+/**
+ * Writes the offsets and vertices of the rows returned by neighbours for every vertex.
+ */
+template <typename Neighbours>
+static void writeRows(std::ofstream& file, size_t numVertices, Neighbours neighbours)
+{
+    std::vector<uint64_t> offsets(1, 0);
+    std::vector<Vertex> vertices;
+    for (Vertex vertex = 0; vertex < numVertices; ++vertex) {
+        VertexRange range = neighbours(vertex);
+        vertices.insert(vertices.end(), range.begin(), range.end());
+        offsets.push_back(vertices.size());
+    }
+
+    writeSection(file, offsets.data(), offsets.size());
+    writeSection(file, vertices.data(), vertices.size());
+}
+
+void writeBinaryParityGame(const ParityGame& game, const char* pgbFilename, bool withPredecessors)
+{
+    std::ofstream file(pgbFilename, std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+        throw std::runtime_error(std::string("Failed to open file ") + pgbFilename);
+    }
+
+    // Vertices are 32-bit, which also bounds the sizes of the arrays below.
+    if (game.getNumberOfVertices() > UINT32_MAX) {
+        throw std::runtime_error(std::string("Too many vertices to write file ") + pgbFilename);
+    }
+
+    Vertex numVertices = (Vertex)game.getNumberOfVertices();
+    uint64_t numEdges = 0;
+    std::vector<uint8_t> ownerBits((numVertices + 7) / 8, 0);
+    std::vector<int32_t> priorities(numVertices);
+    for (Vertex vertex = 0; vertex < numVertices; ++vertex) {
+        numEdges += game.getOutgoingVertices(vertex).size();
+        if (!game.isEven(vertex)) {
+            ownerBits[vertex / 8] |= uint8_t(1 << (vertex % 8));
+        }
+        priorities[vertex] = game.getPriority(vertex);
+    }
+
+    PgbHeader header = { { 'P', 'G', 'B', '1' }, withPredecessors ? PGB_PREDECESSORS : 0, numVertices, numEdges };
+    writeSection(file, &header, 1);
+    writeSection(file, ownerBits.data(), ownerBits.size());
+    writeSection(file, priorities.data(), priorities.size());
+
+    writeRows(file, numVertices, [&game](Vertex vertex) { return game.getOutgoingVertices(vertex); });
+    if (withPredecessors) {
+        writeRows(file, numVertices, [&game](Vertex vertex) { return game.getIncomingVertices(vertex); });
+    }
+
+    if (!file.good()) {
+        throw std::runtime_error(std::string("Failed to write file ") + pgbFilename);
+    }
+}
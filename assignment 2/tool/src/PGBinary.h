@@ -0,0 +1,49 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_PGBINARY_H_
+#define TOOL_PGBINARY_H_
+
+#include "ParityGame.h"
+
+/**
+ * The .pgb format stores a parity game in the byte order of the machine, as the sections below in
+ * this order, where every section starts at a multiple of 8 bytes:
+ *
+ * - the characters "PGB1", a 32-bit flags word and the 64-bit numbers of vertices n and edges m.
+ * - an owner bitmap of n bits, bit v % 8 of byte v / 8 is set if odd owns vertex v.
+ * - n 32-bit priorities.
+ * - n + 1 64-bit successor offsets, followed by the m 32-bit successors of all vertices.
+ * - if flag PGB_PREDECESSORS is set, the predecessor offsets and predecessors in the same way.
+ *
+ * Every row is sorted without duplicates, every vertex has a successor and the predecessors are the
+ * transpose of the successors.
+ */
+const uint32_t PGB_PREDECESSORS = 1;
+
+/**
+ * Reads a parity game in .pgb format from a memory-mapped file.
+ * Throws std::runtime_error if the file cannot be read or is inconsistent.
+ */
+ParityGame readBinaryParityGame(const char* pgbFilename);
+
+/**
+ * Writes the parity game in .pgb format, including its predecessors if withPredecessors is set.
+ * Throws std::runtime_error if the file cannot be written.
+ */
+void writeBinaryParityGame(const ParityGame& game, const char* pgbFilename, bool withPredecessors);
+
+#endif // TOOL_PGBINARY_H_
@@ -16,78 +16,198 @@
 
 #include "PGParser.h"
 
-ParityGame parseParityGame(const char * pgFilename) {
+#include "MappedFile.h"
 
-	std::ifstream ifs(pgFilename);
-	std::string line;
-    
-    if (!ifs.good()) {
-        throw std::runtime_error(std::string("Failed to open file ") + pgFilename);
-    }
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string.h>
 
-	std::getline(ifs, line);
-	line.pop_back();
-	std::vector<std::string> lineSplit = split(line, ' ');
-	int pgSize = std::stoi(lineSplit.at(1)) + 1;
-
-	std::vector<std::set<Vertex>> successors (pgSize);
-	std::vector<std::set<Vertex>> predecessors (pgSize);
-	std::vector<int> owner (pgSize);
-	std::vector<int> priorities (pgSize);
-	std::map<int, int> priorityCount;
-    
-	for (int i = 0; i < pgSize; ++i) {
-		std::getline(ifs, line);
-		line.pop_back();
-		parseLine(line, successors, predecessors, owner, priorities, priorityCount);
-	}
-
-	return ParityGame(successors, predecessors, owner, priorities, priorityCount);
+/**
+ * Skips white space, line breaks and comments.
+ */
+static const char* skipSpaces(const char* cursor, const char* end)
+{
+    while (cursor != end) {
+        if (*cursor == '#') {
+            while (cursor != end && *cursor != '\n') {
+                ++cursor;
+            }
+        }
+        else if (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') {
+            ++cursor;
+        }
+        else {
+            break;
+        }
+    }
+    return cursor;
 }
 
-void parseLine(std::string& line, 
-	std::vector<std::set<Vertex>>& successors,
-	std::vector<std::set<Vertex>>& predecessors, 
-	std::vector<int>& owner,
-	std::vector<int>& priorities, 
-	std::map<int, int>& priorityCount) {
+/**
+ * Skips the given character, preceded by optional spaces, returns false if it is not there.
+ */
+static bool skipCharacter(const char*& cursor, const char* end, char character)
+{
+    cursor = skipSpaces(cursor, end);
+    if (cursor == end || *cursor != character) {
+        return false;
+    }
 
-	std::vector<std::string> lineSplit = split(line, ' ');
+    ++cursor;
+    return true;
+}
 
-	int identifier = std::stoi(lineSplit.at(0));
-	int priority = std::stoi(lineSplit.at(1));
-	int ownedBy = std::stoi(lineSplit.at(2));
+/**
+ * Skips the given keyword followed by a space, returns false if it is not there.
+ */
+static bool skipKeyword(const char*& cursor, const char* end, const char* keyword)
+{
+    size_t length = strlen(keyword);
+    if (size_t(end - cursor) <= length || memcmp(cursor, keyword, length) != 0 || (cursor[length] != ' ' && cursor[length] != '\t')) {
+        return false;
+    }
 
-	std::vector<std::string> succSplit = split(lineSplit.at(3), ',');
+    cursor += length;
+    return true;
+}
 
-	priorities[identifier] = priority;
-	owner[identifier] = ownedBy;
+/**
+ * Reads a non-negative decimal number, preceded by optional spaces.
+ */
+static bool readNumber(const char*& cursor, const char* end, Vertex& value)
+{
+    cursor = skipSpaces(cursor, end);
+    if (cursor == end || *cursor < '0' || *cursor > '9') {
+        return false;
+    }
 
-	for (auto &succ : succSplit) {
-        Vertex successor = std::stoi(succ);
-		successors[identifier].insert(successor);
-        predecessors[successor].insert(identifier);
-	}
+    uint64_t result = 0;
+    while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+        result = result * 10 + (*cursor - '0');
+        if (result >= UINT32_MAX) {
+            return false;
+        }
+        ++cursor;
+    }
 
-	if (priorityCount.count(priority)) {
-		priorityCount[priority] = ++priorityCount[priority];
-	} else {
-		priorityCount[priority] = 1;
-	}
+    value = Vertex(result);
+    return true;
 }
 
-std::vector<std::string> split(const std::string &s, char delim) {
-	std::vector<std::string> elems;
-	split(s, delim, elems);
-	return elems;
+/**
+ * Skips a quoted name, in which a quote can be escaped by a backslash.
+ */
+static bool skipName(const char*& cursor, const char* end)
+{
+    if (!skipCharacter(cursor, end, '"')) {
+        return false;
+    }
+
+    while (cursor != end && *cursor != '"') {
+        if (*cursor == '\\' && cursor + 1 != end) {
+            ++cursor;
+        }
+        ++cursor;
+    }
+    return skipCharacter(cursor, end, '"');
 }
 
-std::vector<std::string> &split(const std::string &s, char delim, 
-	std::vector<std::string> &elems) {
-	std::stringstream ss(s);
-	std::string item;
-	while (std::getline(ss, item, delim)) {
-		elems.push_back(item);
-	}
-	return elems;
+ParityGame parseParityGame(const char* pgFilename)
+{
+    MappedFile file;
+    if (!file.open(pgFilename)) {
+        throw std::runtime_error(std::string("Failed to open file ") + pgFilename);
+    }
+
+    const char* cursor = file.begin();
+    const char* end = file.end();
+
+    std::vector<int> owner;
+    std::vector<int> priorities;
+    std::vector<bool> defined;
+    std::vector<Vertex> edgeSources;
+    std::vector<Vertex> edgeTargets;
+    Vertex numVertices = 0;
+
+    // The header is optional, but allows every vertex to be allocated up front.
+    cursor = skipSpaces(cursor, end);
+    if (skipKeyword(cursor, end, "parity")) {
+        Vertex maximum;
+        if (!readNumber(cursor, end, maximum) || !skipCharacter(cursor, end, ';')) {
+            throw std::runtime_error(std::string("File ") + pgFilename + " has a malformed parity header");
+        }
+
+        numVertices = maximum + 1;
+        owner.resize(numVertices);
+        priorities.resize(numVertices);
+        defined.resize(numVertices, false);
+        edgeSources.reserve(numVertices);
+        edgeTargets.reserve(numVertices);
+    }
+
+    while ((cursor = skipSpaces(cursor, end)) != end) {
+        const char* line = cursor;
+        Vertex identifier;
+        Vertex priority;
+        Vertex ownedBy;
+
+        if (skipKeyword(cursor, end, "start")) {
+            if (!readNumber(cursor, end, identifier) || !skipCharacter(cursor, end, ';')) {
+                throw std::runtime_error("Line " + std::to_string(1 + std::count(file.begin(), line, '\n')) + " of " + pgFilename + " is malformed");
+            }
+            continue;
+        }
+
+        bool valid = readNumber(cursor, end, identifier) && readNumber(cursor, end, priority) && readNumber(cursor, end, ownedBy) && ownedBy <= 1;
+        if (valid && identifier >= numVertices) {
+            numVertices = identifier + 1;
+            owner.resize(numVertices);
+            priorities.resize(numVertices);
+            defined.resize(numVertices, false);
+        }
+
+        // The successors are separated by commas.
+        Vertex successor;
+        valid = valid && !defined[identifier] && readNumber(cursor, end, successor);
+        while (valid) {
+            edgeSources.push_back(identifier);
+            edgeTargets.push_back(successor);
+            if (!skipCharacter(cursor, end, ',')) {
+                break;
+            }
+            valid = readNumber(cursor, end, successor);
+        }
+
+        // The name is optional, the semicolon may be left out at the end of the file.
+        const char* name = skipSpaces(cursor, end);
+        if (valid && name != end && *name == '"') {
+            valid = skipName(cursor, end);
+        }
+        valid = valid && (skipCharacter(cursor, end, ';') || skipSpaces(cursor, end) == end);
+
+        if (!valid) {
+            throw std::runtime_error("Line " + std::to_string(1 + std::count(file.begin(), line, '\n')) + " of " + pgFilename + " is malformed");
+        }
+
+        owner[identifier] = int(ownedBy);
+        priorities[identifier] = int(priority);
+        defined[identifier] = true;
+    }
+
+    // Every vertex, including all successors, must have been specified.
+    if (numVertices == 0) {
+        throw std::runtime_error(std::string("File ") + pgFilename + " has no vertices");
+    }
+    for (auto target : edgeTargets) {
+        numVertices = std::max(numVertices, target + 1);
+    }
+    defined.resize(numVertices, false);
+    for (Vertex vertex = 0; vertex < numVertices; ++vertex) {
+        if (!defined[vertex]) {
+            throw std::runtime_error("Vertex " + std::to_string(vertex) + " is not specified in " + pgFilename);
+        }
+    }
+
+    return ParityGame(std::move(owner), std::move(priorities), std::move(edgeSources), std::move(edgeTargets));
 }
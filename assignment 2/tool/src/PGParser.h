@@ -17,41 +17,16 @@
 #ifndef TOOL_PGPPARSER_H_
 #define TOOL_PGPPARSER_H_
 
-#include <stdio.h>  
-#include <iostream>
-#include <fstream>  
-#include <string>
-#include <map>
-#include <set>
-#include <sstream>
-#include <vector>
-
 #include "ParityGame.h"
 
 /**
  * Parses a parity game file in .gm format and returns a ParityGame object.
+ *
+ * Every vertex is specified as "<identifier> <priority> <owner> <successor>,...,<successor>", optionally
+ * followed by a quoted name, and ends with a semicolon. The vertices may be listed in any order, the
+ * "parity <maximum identifier>;" header and "start <identifier>;" are optional and text from a '#'
+ * up to the end of the line is ignored. Throws std::runtime_error if the file cannot be read.
  */
 ParityGame parseParityGame(const char* pgFilename);
 
-/**
- * Parses a single line from a .gm format parity game file.
- */
-void parseLine(std::string& line,
-	std::vector<std::set<Vertex>>& successors,
-	std::vector<std::set<Vertex>>& predecessors,
-	std::vector<int>& owner,
-	std::vector<int>& priorities,
-	std::map<int, int>& priorityCount);
-
-/**
- * Splits a string based on a delimiter.
- */
-std::vector<std::string> split(const std::string &s, char delim);
-
-/**
- * Actual splitting happens here.
- */
-std::vector<std::string> &split(const std::string &s, char delim,
-	std::vector<std::string> &elems);
-
 #endif /* PGParser_h */
@@ -16,21 +16,142 @@
 
 #include "PGSolver.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <tuple>
 
-using Measures = std::vector<uint32_t>;
-const static Measures TOP(1, 1);
+/**
+ * A progress measure is stored as a row of values for the odd priorities only, value i belongs to
+ * priority 2 * i + 1 and values are compared lexicographically starting from value 0. A measure is
+ * TOP if its first value is TOP_VALUE, the remaining values are then meaningless.
+ */
+const static uint32_t TOP_VALUE = UINT32_MAX;
+
+/**
+ * The measures of all vertices, stored as one contiguous matrix with a row per vertex.
+ */
+class MeasureMatrix {
+public:
+    MeasureMatrix(size_t numRows, size_t width) :
+        m_width(width),
+        m_values(numRows * width, 0)
+    {}
+
+    uint32_t* operator[](Vertex vertex) { return &m_values[vertex * m_width]; }
+    const uint32_t* operator[](Vertex vertex) const { return &m_values[vertex * m_width]; }
+
+    /**
+     * Returns the measure of the vertex, buffer is not needed.
+     */
+    const uint32_t* read(Vertex vertex, uint32_t* /*buffer*/) const { return (*this)[vertex]; }
+
+private:
+    size_t m_width;
+    std::vector<uint32_t> m_values;
+};
+
+/**
+ * The measures of all vertices shared by multiple threads.
+ *
+ * Every row has a version that is odd while the row is being written, such that a reader can copy
+ * a consistent measure by retrying until the version was even and unchanged during the copy. A
+ * writer only publishes its measure if the version did not change since it read the old measure.
+ */
+class SharedMeasureMatrix {
+public:
+    SharedMeasureMatrix(size_t numRows, size_t width) :
+        m_width(width),
+        m_values(numRows * width),
+        m_versions(numRows)
+    {
+        for (auto& value : m_values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+        for (auto& version : m_versions) {
+            version.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Copies the measure of the vertex into buffer and returns it.
+     */
+    const uint32_t* read(Vertex vertex, uint32_t* buffer) const
+    {
+        uint32_t version;
+        readVersioned(vertex, buffer, version);
+        return buffer;
+    }
+
+    /**
+     * Copies the measure of the vertex into buffer, with the version it was copied at.
+     */
+    void readVersioned(Vertex vertex, uint32_t* buffer, uint32_t& version) const
+    {
+        const std::atomic<uint32_t>* row = &m_values[vertex * m_width];
+        while (true) {
+            version = m_versions[vertex].load(std::memory_order_acquire);
+            if (version % 2 == 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t index = 0; index < m_width; ++index) {
+                buffer[index] = row[index].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_versions[vertex].load(std::memory_order_relaxed) == version) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Replaces the measure of the vertex if it still has the given version, returns whether it did.
+     */
+    bool write(Vertex vertex, const uint32_t* measure, uint32_t version)
+    {
+        if (!m_versions[vertex].compare_exchange_strong(version, version + 1, std::memory_order_acq_rel)) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::atomic<uint32_t>* row = &m_values[vertex * m_width];
+        for (size_t index = 0; index < m_width; ++index) {
+            row[index].store(measure[index], std::memory_order_relaxed);
+        }
+
+        m_versions[vertex].store(version + 2, std::memory_order_release);
+        return true;
+    }
+
+private:
+    size_t m_width;
+    std::vector<std::atomic<uint32_t>> m_values;
+    std::vector<std::atomic<uint32_t>> m_versions;
+};
+
+/**
+ * Returns the number of values in a measure, which is the number of odd priorities up to the
+ * maximum priority, but at least one such that TOP can be stored.
+ */
+static size_t getMeasureWidth(const ParityGame& game) {
+    return std::max<size_t>((game.getMaximumPriority() + 1) / 2, 1);
+}
 
 /**
  * Check whether all values in a measure a 0.
  */
-static bool isBottom(const Measures& measure) {
-	if (measure == TOP){
-		return false;
-	}
-    for (size_t index = 1; index < measure.size(); index += 2) {
+static bool isBottom(const uint32_t* measure, size_t width) {
+    if (measure[0] == TOP_VALUE) {
+        return false;
+    }
+    for (size_t index = 0; index < width; ++index) {
         if (measure[index] != 0) {
             return false;
         }
@@ -42,11 +163,11 @@ static bool isBottom(const Measures& measure) {
 /**
  * Gets the progress measures for a parity game
  */
-static Measures getProgressMeasures(const ParityGame& game) {
-    Measures progMeasures(game.getMaximumPriority() + 1);
+static std::vector<uint32_t> getProgressMeasures(const ParityGame& game) {
+    std::vector<uint32_t> progMeasures(getMeasureWidth(game));
 
-    for (int i = 1; i < progMeasures.size(); i += 2) {
-        progMeasures[i] = game.getPriorityCount(i);
+    for (size_t i = 0; i < progMeasures.size(); ++i) {
+        progMeasures[i] = game.getPriorityCount(2 * i + 1);
     }
 
     return progMeasures;
@@ -54,181 +175,355 @@ static Measures getProgressMeasures(const ParityGame& game) {
 
 /**
  * Computes whether a measure1 is lexicographically greater than measure2.
- *
- * @param[in] limit How many elements of the tuple to check.
  */
-static bool lexicoGreaterThan(const Measures& measure1, const Measures& measure2, bool strict = true, unsigned int limit = -1)
+static bool lexicoGreaterThan(const uint32_t* measure1, const uint32_t* measure2, size_t width)
 {
     //cases for TOP
-    if (measure2 == TOP) {
-        if (measure1 == TOP) {
-            return !strict;
-        }
-        else {
-            return false;
-        }
+    if (measure2[0] == TOP_VALUE) {
+        return false;
     }
-    else {
-        if (measure1 == TOP) {
+    if (measure1[0] == TOP_VALUE) {
+        return true;
+    }
+
+    // when both are not TOP
+    for (size_t index = 0; index < width; ++index) {
+        if (measure1[index] > measure2[index]) {
             return true;
         }
-        else { // when both are not TOP
-            for (size_t index = 1; index <= limit && index < measure1.size(); index += 2) {
-                if (measure1[index] > measure2[index]) {
-                    return true;
-                }
-				else if (measure1[index] < measure2[index]){
-					return false;
-				}
-            }
-            return !strict; // Both are equal, so for strict this is false and otherwise true.
+        else if (measure1[index] < measure2[index]) {
+            return false;
         }
     }
+    return false; // Both are equal.
 }
 
 /**
- * Computes Prog, the progress measure.
+ * Computes Prog, the progress measure of vertex v for its successor with measure succMeasure, in newMeasure.
  */
-static Measures prog(const ParityGame& game, Measures& maxMeasures, const std::vector<Measures>& parProgMeasures, Vertex v, Vertex w)
+static void prog(const ParityGame& game, const std::vector<uint32_t>& maxMeasures, const uint32_t* succMeasure, Vertex v, uint32_t* newMeasure)
 {
-    Measures newMeasure(maxMeasures.size(), 0);
-    Measures succMeasure(parProgMeasures[w]);
+    size_t width = maxMeasures.size();
     int priority = game.getPriority(v);
 
     //if the measure of w is TOP, the measure of v will be TOP as well
-    if (succMeasure == TOP) {
-        return TOP;
+    if (succMeasure[0] == TOP_VALUE) {
+        newMeasure[0] = TOP_VALUE;
+        return;
     }
 
     // case even priority
     if (priority % 2 == 0) {
         // fill with same values as w upto priority (no need to include priority since it is even), keep the rest zero
-        for (int i = 1; i < priority; i += 2) {
-            newMeasure[i] = succMeasure[i];
-        }
+        size_t end = std::min<size_t>(priority / 2, width);
+        std::copy(succMeasure, succMeasure + end, newMeasure);
+        std::fill(newMeasure + end, newMeasure + width, 0);
     }
     // case for odd priority
     else {
-        // try to make the measure strictly bigger than that of w, going from priority to 1
+        // try to make the measure strictly bigger than that of w, going from priority to 1, the
+        // values after the increased one are reset to zero to get the least such measure
         // if not possible, it is TOP
+        size_t end = std::min<size_t>(priority / 2 + 1, width);
+        std::fill(newMeasure + end, newMeasure + width, 0);
+
         bool madeStrictlyGreater = false;
-        for (int i = priority; i > 0; i -= 2) {
-            if (!madeStrictlyGreater && succMeasure[i] < maxMeasures[i]) {
+        for (size_t i = end; i-- > 0;) {
+            if (madeStrictlyGreater) {
+                newMeasure[i] = succMeasure[i];
+            }
+            else if (succMeasure[i] < maxMeasures[i]) {
                 newMeasure[i] = succMeasure[i] + 1;
                 madeStrictlyGreater = true;
             }
             else {
-                newMeasure[i] = succMeasure[i];
+                newMeasure[i] = 0;
             }
         }
         if (!madeStrictlyGreater) {
-            newMeasure = TOP;
+            newMeasure[0] = TOP_VALUE;
         }
     }
-
-    return newMeasure;
 }
 
 /**
-* Lift the Measures for the specified vertex.
+* Lift the measure for the specified vertex into result, progress and successor are used as scratch space.
+* Returns false if the vertex has no successors, its measure then stays the same.
 */
-Measures lift(const ParityGame& game, Measures maxMeasures, const std::vector<Measures>& progMeasures, Vertex vertex)
+template <typename Matrix>
+static bool lift(const ParityGame& game, const std::vector<uint32_t>& maxMeasures, const Matrix& progMeasures, Vertex vertex,
+    uint32_t* result, uint32_t* progress, uint32_t* successor)
 {
-    Measures result;
+    size_t width = maxMeasures.size();
+    bool initialised = false;
 
     for (auto outgoingVertex : game.getOutgoingVertices(vertex)) {
-        Measures progress = prog(game, maxMeasures, progMeasures, vertex, outgoingVertex);
-
-        if (result.size() == 0) {
-            // Initialize the result to the first value.
-            result = progress;
-        }
-
         if (game.isEven(vertex)) {
             if (vertex == outgoingVertex && game.getPriority(vertex) % 2 == 0) {
-				//if it is a self loop with an even priority return the minimal measure
-                return Measures(game.getMaximumPriority() + 1, 0);
-            }
-
-            result = lexicoGreaterThan(progress, result) ? result : progress; // Minimize result
-
-            if (isBottom(result)) {
-                // if it has the minimum value, return it immediately
-                return result;
+                //if it is a self loop with an even priority return the minimal measure
+                std::fill(result, result + width, 0);
+                return true;
             }
         }
-        else {
-            if (vertex == outgoingVertex && game.getPriority(vertex) % 2 == 1) {
-                // If it is a selfloop with an odd priority return TOP.
-                return TOP;
-            }
+        else if (vertex == outgoingVertex && game.getPriority(vertex) % 2 == 1) {
+            // If it is a selfloop with an odd priority return TOP.
+            result[0] = TOP_VALUE;
+            return true;
+        }
 
-            result = lexicoGreaterThan(progress, result) ? progress : result; // Maximize result
+        prog(game, maxMeasures, progMeasures.read(outgoingVertex, successor), vertex, progress);
 
-            if (result == TOP) {
-                // if it has the maximum value, return it immediately
-                return result;
-            }
+        if (!initialised) {
+            // Initialize the result to the first value.
+            std::copy(progress, progress + width, result);
+            initialised = true;
+        }
+        else if (game.isEven(vertex) ? lexicoGreaterThan(result, progress, width) : lexicoGreaterThan(progress, result, width)) {
+            // Minimize the result for even, maximize it for odd.
+            std::copy(progress, progress + width, result);
         }
 
+        if (game.isEven(vertex) ? isBottom(result, width) : result[0] == TOP_VALUE) {
+            // if it has the minimum respectively maximum value, return it immediately
+            return true;
+        }
     }
 
-    return result;
+    return initialised;
 }
 
-std::vector<bool> solveParityGame(const ParityGame& game, const std::vector<Vertex>& order, bool fullPartition)
+/**
+ * Gathers the winners from the final measures as returned by the solvers.
+ */
+template <typename Matrix>
+static std::vector<bool> getWinners(const ParityGame& game, const Matrix& vertexToMeasures, size_t width, bool fullPartition)
 {
-    // For every vector set the zeroed Measure tuple.
-    std::vector<Measures> vertexToMeasures(game.getNumberOfVertices());
-    for (auto& measure : vertexToMeasures) {
-        measure = Measures(game.getMaximumPriority() + 1, 0);
-    }
-
-    // Gets the initial progress measures.
-    Measures maxMeasures = getProgressMeasures(game);
-
-    // Indicates whether the set of measures has been increased this iteration
-    bool increased = false;
-
-    do {
-        increased = false;
-        // Follow the order specified at the parameter.
-        for (auto vertex : order) {
-            // Lift a single vertex and and check whether its measures have increased.
-            Measures& measures = vertexToMeasures[vertex];
-            Measures newMeasures = lift(game, maxMeasures, vertexToMeasures, vertex);
-
-            // If it has been lifted, fill it in in the measures and set it to increased
-            if (lexicoGreaterThan(newMeasures, measures)) {
-                vertexToMeasures[vertex] = newMeasures;
-                increased = true;
-            }
-        }
-
-    } while (increased);
+    std::vector<uint32_t> buffer(width);
 
     // Gather the set that don't equal Top and put true for them.
     if (fullPartition) {
         std::vector<bool> evenDominated = std::vector<bool>(game.getNumberOfVertices());
 
-        Vertex index = 0;
-        for (auto measures : vertexToMeasures) {
-            if (measures != TOP) {
+        for (Vertex index = 0; index < game.getNumberOfVertices(); ++index) {
+            if (vertexToMeasures.read(index, buffer.data())[0] != TOP_VALUE) {
                 // Not equal top implies winning set for even.
                 evenDominated[index] = true;
             }
-
-            ++index;
         }
 
         return evenDominated;
     }
     else {
-        if (vertexToMeasures[0] != TOP) {
+        if (vertexToMeasures.read(0, buffer.data())[0] != TOP_VALUE) {
             return{ true };
         }
         else {
             return{ false };
         }
     }
-}
\ No newline at end of file
+}
+
+std::vector<bool> solveParityGame(const ParityGame& game, const LiftingStrategy& strategy, bool fullPartition, LiftStatistics& statistics)
+{
+    statistics.lifts = statistics.increases = 0;
+
+    std::vector<Vertex> order = strategy.getInitialOrder(game);
+
+    // Gets the initial progress measures.
+    std::vector<uint32_t> maxMeasures = getProgressMeasures(game);
+    size_t width = maxMeasures.size();
+
+    // For every vertex set the zeroed measure.
+    MeasureMatrix vertexToMeasures(game.getNumberOfVertices(), width);
+    std::vector<uint32_t> newMeasures(width);
+    std::vector<uint32_t> progress(width);
+
+    // The vertices that have to be lifted, initially in the order of the strategy.
+    std::deque<Vertex> worklist(order.begin(), order.end());
+    std::vector<bool> queued(game.getNumberOfVertices(), false);
+    for (auto vertex : order) {
+        queued[vertex] = true;
+    }
+
+    while (!worklist.empty()) {
+        Vertex vertex = worklist.front();
+        worklist.pop_front();
+        queued[vertex] = false;
+
+        // Lift a single vertex and and check whether its measures have increased.
+        uint32_t* measures = vertexToMeasures[vertex];
+        bool lifted = lift(game, maxMeasures, vertexToMeasures, vertex, newMeasures.data(), progress.data(), nullptr);
+        ++statistics.lifts;
+
+        // If it has been lifted, fill it in in the measures and requeue the vertices depending on it.
+        if (lifted && lexicoGreaterThan(newMeasures.data(), measures, width)) {
+            ++statistics.increases;
+            std::copy(newMeasures.begin(), newMeasures.end(), measures);
+
+            for (auto predecessor : game.getIncomingVertices(vertex)) {
+                if (!queued[predecessor]) {
+                    queued[predecessor] = true;
+                    if (strategy.liftFirst(game, vertex, predecessor)) {
+                        worklist.push_front(predecessor);
+                    }
+                    else {
+                        worklist.push_back(predecessor);
+                    }
+                }
+            }
+        }
+    }
+
+    return getWinners(game, vertexToMeasures, width, fullPartition);
+}
+
+/**
+ * The work queue of a single thread, other threads steal from its back when they run out of work.
+ */
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Vertex> vertices;
+};
+
+/**
+ * Lifts vertices from the queue of the given thread, or the queues of other threads, until no
+ * vertex is queued or being lifted anymore. The lifts of the thread are counted in statistics.
+ */
+static void liftParallel(const ParityGame& game, const LiftingStrategy& strategy, const std::vector<uint32_t>& maxMeasures, SharedMeasureMatrix& vertexToMeasures,
+    std::vector<WorkQueue>& queues, size_t thread, std::vector<std::atomic<bool>>& queued, std::atomic<size_t>& pending, LiftStatistics& statistics)
+{
+    size_t width = maxMeasures.size();
+    std::vector<uint32_t> measures(width);
+    std::vector<uint32_t> newMeasures(width);
+    std::vector<uint32_t> progress(width);
+    std::vector<uint32_t> successor(width);
+
+    while (true) {
+        Vertex vertex = 0;
+        bool found = false;
+
+        for (size_t offset = 0; offset < queues.size() && !found; ++offset) {
+            WorkQueue& queue = queues[(thread + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.vertices.empty()) {
+                // Take from the front of the own queue, but steal from the back of another one.
+                if (offset == 0) {
+                    vertex = queue.vertices.front();
+                    queue.vertices.pop_front();
+                }
+                else {
+                    vertex = queue.vertices.back();
+                    queue.vertices.pop_back();
+                }
+                found = true;
+            }
+        }
+
+        if (!found) {
+            if (pending.load() == 0) {
+                return;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Clear the flag before reading the successors, such that a successor lifted during this lift queues it again.
+        queued[vertex].exchange(false);
+
+        while (true) {
+            uint32_t version;
+            vertexToMeasures.readVersioned(vertex, measures.data(), version);
+
+            bool lifted = lift(game, maxMeasures, vertexToMeasures, vertex, newMeasures.data(), progress.data(), successor.data());
+            ++statistics.lifts;
+            if (!lifted || !lexicoGreaterThan(newMeasures.data(), measures.data(), width)) {
+                break;
+            }
+
+            if (vertexToMeasures.write(vertex, newMeasures.data(), version)) {
+                ++statistics.increases;
+                for (auto predecessor : game.getIncomingVertices(vertex)) {
+                    if (!queued[predecessor].exchange(true)) {
+                        ++pending;
+                        std::lock_guard<std::mutex> lock(queues[thread].mutex);
+                        if (strategy.liftFirst(game, vertex, predecessor)) {
+                            queues[thread].vertices.push_front(predecessor);
+                        }
+                        else {
+                            queues[thread].vertices.push_back(predecessor);
+                        }
+                    }
+                }
+                break;
+            }
+
+            // Another thread lifted the vertex in the meantime, so lift it again from its new measure.
+        }
+
+        --pending;
+    }
+}
+
+bool parseNumberOfThreads(const std::string& text, unsigned& numThreads)
+{
+    if (text.empty() || text.size() > 4 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    unsigned value = std::stoul(text);
+    if (value > MAX_THREADS) {
+        return false;
+    }
+    numThreads = value;
+    return true;
+}
+
+std::vector<bool> solveParityGameParallel(const ParityGame& game, const LiftingStrategy& strategy, bool fullPartition, unsigned numThreads,
+    LiftStatistics& statistics)
+{
+    std::vector<Vertex> order = strategy.getInitialOrder(game);
+
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Gets the initial progress measures.
+    std::vector<uint32_t> maxMeasures = getProgressMeasures(game);
+    size_t width = maxMeasures.size();
+    SharedMeasureMatrix vertexToMeasures(game.getNumberOfVertices(), width);
+
+    // Deal the vertices over the threads in blocks of the initial order.
+    std::vector<WorkQueue> queues(numThreads);
+    std::vector<std::atomic<bool>> queued(game.getNumberOfVertices());
+    for (auto& flag : queued) {
+        flag.store(false, std::memory_order_relaxed);
+    }
+
+    size_t blockSize = (order.size() + numThreads - 1) / numThreads;
+    for (size_t index = 0; index < order.size(); ++index) {
+        queued[order[index]].store(true, std::memory_order_relaxed);
+        queues[index / blockSize].vertices.push_back(order[index]);
+    }
+    std::atomic<size_t> pending(order.size());
+
+    // Every thread counts its own lifts, which are summed afterwards.
+    std::vector<LiftStatistics> threadStatistics(numThreads, LiftStatistics{ 0, 0 });
+    std::vector<std::thread> threads;
+    for (size_t thread = 1; thread < numThreads; ++thread) {
+        threads.emplace_back(liftParallel, std::cref(game), std::cref(strategy), std::cref(maxMeasures), std::ref(vertexToMeasures),
+            std::ref(queues), thread, std::ref(queued), std::ref(pending), std::ref(threadStatistics[thread]));
+    }
+    liftParallel(game, strategy, maxMeasures, vertexToMeasures, queues, 0, queued, pending, threadStatistics[0]);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    statistics.lifts = statistics.increases = 0;
+    for (auto& counted : threadStatistics) {
+        statistics.lifts += counted.lifts;
+        statistics.increases += counted.increases;
+    }
+
+    return getWinners(game, vertexToMeasures, width, fullPartition);
+}
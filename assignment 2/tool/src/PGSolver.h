@@ -17,16 +17,59 @@
 #ifndef TOOL_PGSOLVER_H_
 #define TOOL_PGSOLVER_H_
 
+#include "LiftingStrategy.h"
 #include "ParityGame.h"
 
+#include <stddef.h>
+#include <string>
 #include <vector>
 
+/**
+ * The largest number of threads that solveParityGameParallel accepts from the command line.
+ */
+const unsigned MAX_THREADS = 1024;
+
+/**
+ * Reads the number of threads of --threads=N from text into numThreads, where 0 means the number of
+ * cores. Returns false if text is not a decimal number up to MAX_THREADS.
+ */
+bool parseNumberOfThreads(const std::string& text, unsigned& numThreads);
+
+/**
+ * The amount of work done by small progress measures.
+ *
+ * @lifts, the number of times a vertex was lifted.
+ * @increases, the number of lifts that increased the measure of the vertex.
+ */
+struct LiftStatistics {
+    size_t lifts;
+    size_t increases;
+};
+
 /**
  * Solves the given parity game. 
  *
- * @param[in] order The order in which the vertices are lifted, each index specifies the index of the vertex lifted.
+ * Vertices are lifted from a worklist: after a vertex is lifted, only its predecessors are queued
+ * again, each vertex being queued at most once at a time.
+ *
+ * @param[in] strategy The strategy deciding the order in which the vertices are lifted.
  * @param[in] fullPartition Indicate that the vector contains true|false for every vertex, otherwise only for vertex 0.
+ * @param[out] statistics The number of lifts and of lifts that increased a measure.
+ */
+std::vector<bool> solveParityGame(const ParityGame& game, const LiftingStrategy& strategy, bool fullPartition, LiftStatistics& statistics);
+
+/**
+ * Solves the given parity game like solveParityGame, but lifts vertices on multiple threads.
+ *
+ * Every thread lifts from its own worklist and steals from the others when it runs out. A measure
+ * is only replaced if it was not replaced by another thread since it was read, otherwise the vertex
+ * is lifted again. As measures only increase up to the same least fixed point, the result is the
+ * same as the sequential one.
+ *
+ * @param[in] numThreads The number of threads to lift with, 0 for the number of cores.
+ * @param[out] statistics The number of lifts and of lifts that increased a measure, over all threads.
  */
-std::vector<bool> solveParityGame(const ParityGame& game, const std::vector<Vertex>& order, bool fullPartition);
+std::vector<bool> solveParityGameParallel(const ParityGame& game, const LiftingStrategy& strategy, bool fullPartition, unsigned numThreads,
+    LiftStatistics& statistics);
 
 #endif // PGSOLVER_H_
@@ -16,42 +16,101 @@
 
 #include "ParityGame.h"
 
-ParityGame::ParityGame(std::vector<std::set<Vertex>>& successors,
-    std::vector<std::set<Vertex>>& predecessors,
-    std::vector<int>& owner,
-    std::vector<int>& priority,
-    std::map<int, int>& priorityCount)
-{
-    this->owner = owner;
-    this->successors = successors;
-    this->predecessors = predecessors;
-    this->priority = priority;
-    this->priorityCount = priorityCount;
-}
+#include <algorithm>
 
-bool ParityGame::isEven(Vertex vertex) const
+ParityGame::ParityGame(std::vector<int>&& owner,
+    std::vector<int>&& priority,
+    std::vector<Vertex>&& edgeSources,
+    std::vector<Vertex>&& edgeTargets) :
+    owner(std::move(owner)),
+    priority(std::move(priority))
 {
-    return (owner.at(vertex) == 0) ? true : false;
-}
+    size_t numVertices = this->owner.size();
 
-std::set<Vertex> ParityGame::getOutgoingVertices(Vertex vertex) const
-{
-    return successors.at(vertex);
+    // Count the successors of every vertex and place the edges in their rows.
+    successorOffsets.assign(numVertices + 1, 0);
+    for (auto source : edgeSources) {
+        ++successorOffsets[source + 1];
+    }
+    for (size_t vertex = 0; vertex < numVertices; ++vertex) {
+        successorOffsets[vertex + 1] += successorOffsets[vertex];
+    }
+
+    std::vector<size_t> next(successorOffsets.begin(), successorOffsets.end() - 1);
+    successors.resize(edgeTargets.size());
+    for (size_t edge = 0; edge < edgeSources.size(); ++edge) {
+        successors[next[edgeSources[edge]]++] = edgeTargets[edge];
+    }
+    std::vector<Vertex>().swap(edgeSources);
+    std::vector<Vertex>().swap(edgeTargets);
+
+    // Sort every row and remove duplicates, moving the rows to the front.
+    size_t size = 0;
+    for (size_t vertex = 0; vertex < numVertices; ++vertex) {
+        auto first = successors.begin() + successorOffsets[vertex];
+        auto last = successors.begin() + successorOffsets[vertex + 1];
+        std::sort(first, last);
+        last = std::unique(first, last);
+
+        successorOffsets[vertex] = size;
+        size = std::copy(first, last, successors.begin() + size) - successors.begin();
+    }
+    successorOffsets[numVertices] = size;
+    successors.resize(size);
+    successors.shrink_to_fit();
+
+    initialise();
 }
 
-std::set<Vertex> ParityGame::getIncomingVertices(Vertex vertex) const
+ParityGame::ParityGame(std::vector<int>&& owner,
+    std::vector<int>&& priority,
+    std::vector<size_t>&& successorOffsets,
+    std::vector<Vertex>&& successors,
+    std::vector<size_t>&& predecessorOffsets,
+    std::vector<Vertex>&& predecessors) :
+    successorOffsets(std::move(successorOffsets)),
+    successors(std::move(successors)),
+    predecessorOffsets(std::move(predecessorOffsets)),
+    predecessors(std::move(predecessors)),
+    owner(std::move(owner)),
+    priority(std::move(priority))
 {
-    return predecessors.at(vertex);
+    initialise();
 }
 
-size_t ParityGame::getNumberOfVertices() const
+void ParityGame::initialise()
 {
-    return successors.size();
+    size_t numVertices = owner.size();
+
+    if (predecessorOffsets.empty()) {
+        // The predecessors are placed in increasing order by going over the sources in increasing order.
+        predecessorOffsets.assign(numVertices + 1, 0);
+        for (auto target : successors) {
+            ++predecessorOffsets[target + 1];
+        }
+        for (size_t vertex = 0; vertex < numVertices; ++vertex) {
+            predecessorOffsets[vertex + 1] += predecessorOffsets[vertex];
+        }
+
+        std::vector<size_t> next(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+        predecessors.resize(successors.size());
+        for (Vertex vertex = 0; vertex < numVertices; ++vertex) {
+            for (auto successor : getOutgoingVertices(vertex)) {
+                predecessors[next[successor]++] = vertex;
+            }
+        }
+    }
+
+    for (auto value : priority) {
+        ++priorityCount[value];
+    }
+    maxPriority = priorityCount.empty() ? 0 : priorityCount.rbegin()->first;
 }
 
-int ParityGame::getPriority(Vertex vertex) const
+bool ParityGame::hasEdge(Vertex vertex, Vertex successor) const
 {
-    return priority.at(vertex);
+    VertexRange range = getOutgoingVertices(vertex);
+    return std::binary_search(range.begin(), range.end(), successor);
 }
 
 int ParityGame::getPriorityCount(int priority) const
@@ -64,19 +123,14 @@ int ParityGame::getPriorityCount(int priority) const
 
 size_t ParityGame::getMaximumPriority() const
 {
-    if (priorityCount.count(0) == 0) {
-        return priorityCount.size();
-    }
-    else {
-        return priorityCount.size() - 1;
-    }
+    return maxPriority;
 }
 
 void ParityGame::print() const
 {
-    for (int i = 0; i < successors.size(); ++i) {
+    for (Vertex i = 0; i < owner.size(); ++i) {
         std::cout << i << " " << priority.at(i) << " " << owner.at(i) << " ";
-        for (auto &s : successors.at(i)) {
+        for (auto s : getOutgoingVertices(i)) {
             std::cout << s << " ";
         }
         std::cout << "\n";
@@ -19,16 +19,38 @@
 
 #include <iostream>
 #include <map>
-#include <set>
 #include <vector>
+#include <stddef.h>
 #include <stdint.h> //DONT REMOVE THIS
 
 using Vertex = uint32_t;
 
+/**
+ * A contiguous range of vertices, such as the successors of a vertex.
+ */
+class VertexRange {
+public:
+    VertexRange(const Vertex* first, const Vertex* last) :
+        m_first(first),
+        m_last(last)
+    {}
+
+    const Vertex* begin() const { return m_first; }
+    const Vertex* end() const { return m_last; }
+    size_t size() const { return m_last - m_first; }
+    bool empty() const { return m_first == m_last; }
+
+private:
+    const Vertex* m_first;
+    const Vertex* m_last;
+};
+
 /**
  * Parity game object definition.
  *
- * @successors, mapping from a vertex to a set of its successor vertices.
+ * The successors and predecessors are stored in compressed sparse rows: the neighbours of vertex v
+ * are sorted at index successorOffsets[v] up to successorOffsets[v + 1] of successors, and likewise for predecessors.
+ *
  * @owner, mapping from a vertex to its owner. 0 for even, 1 for uneven.
  * @priority, mapping from a vertex to its priority.
  * @priorityCount, mapping from a priority to how often it occurs in the parity game.
@@ -38,34 +60,56 @@ class ParityGame {
 public:
 
 	/**
-	* Constructor
-	*/
-	ParityGame(std::vector<std::set<Vertex>>& successors,
-		std::vector<std::set<Vertex>>& predecessors,
-		std::vector<int>& owner,
-		std::vector<int>& priority,
-		std::map<int, int>& priorityCount);
+	 * Constructor, the game has an edge from edgeSources[i] to edgeTargets[i] for every index i.
+	 * Duplicate edges are removed, the vectors are taken over by the game.
+	 */
+	ParityGame(std::vector<int>&& owner,
+		std::vector<int>&& priority,
+		std::vector<Vertex>&& edgeSources,
+		std::vector<Vertex>&& edgeTargets);
+
+	/**
+	 * Constructor from compressed sparse rows, every row of successors must be sorted without
+	 * duplicates. The predecessors are derived from the successors if they are left empty.
+	 */
+	ParityGame(std::vector<int>&& owner,
+		std::vector<int>&& priority,
+		std::vector<size_t>&& successorOffsets,
+		std::vector<Vertex>&& successors,
+		std::vector<size_t>&& predecessorOffsets = std::vector<size_t>(),
+		std::vector<Vertex>&& predecessors = std::vector<Vertex>());
 
 	/**
 	 * Returns the owner of a vertex. 
 	 * 1 if even, 0 if uneven
 	 */
-	bool isEven(Vertex vertex) const;
+	bool isEven(Vertex vertex) const { return owner[vertex] == 0; }
 
 	/**
-	 * Returns the direct successors of a vertex. 
+	 * Returns the direct successors of a vertex, in increasing order.
 	 */
-	std::set<Vertex> getOutgoingVertices(Vertex vertex) const;
+	VertexRange getOutgoingVertices(Vertex vertex) const
+	{
+		return VertexRange(successors.data() + successorOffsets[vertex], successors.data() + successorOffsets[vertex + 1]);
+	}
     
     /**
-     * Returns the direct predecessors of a vertex.
+     * Returns the direct predecessors of a vertex, in increasing order.
      */
-    std::set<Vertex> getIncomingVertices(Vertex vertex) const;
+    VertexRange getIncomingVertices(Vertex vertex) const
+    {
+        return VertexRange(predecessors.data() + predecessorOffsets[vertex], predecessors.data() + predecessorOffsets[vertex + 1]);
+    }
+
+    /**
+     * Returns whether there is an edge from vertex to successor.
+     */
+    bool hasEdge(Vertex vertex, Vertex successor) const;
 
     /**
      * Gets the total number of vertices.
      */
-    size_t getNumberOfVertices() const;
+    size_t getNumberOfVertices() const { return owner.size(); }
 
     /**
      * Gets the highest priority.
@@ -75,7 +119,7 @@ public:
 	/**
 	 * Returns the priority of a vertex.
 	 */
-	int getPriority(Vertex vertex) const;
+	int getPriority(Vertex vertex) const { return priority[vertex]; }
 
 	/**
 	 * Returns the count of a priority.
@@ -88,8 +132,15 @@ public:
 	void print() const;
 
 private:
-	std::vector<std::set<Vertex>> successors;
-	std::vector<std::set<Vertex>> predecessors;
+	/**
+	 * Derives the predecessors if they are not given, and counts the priorities.
+	 */
+	void initialise();
+
+	std::vector<size_t> successorOffsets;
+	std::vector<Vertex> successors;
+	std::vector<size_t> predecessorOffsets;
+	std::vector<Vertex> predecessors;
 	std::vector<int> owner;
 	std::vector<int> priority;
 	std::map<int, int> priorityCount;
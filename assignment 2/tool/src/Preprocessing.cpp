@@ -0,0 +1,421 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Preprocessing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
+
+/**
+ * Indicates that a vertex is not (yet) part of the structure it is indexed in.
+ */
+const static Vertex NO_VERTEX = UINT32_MAX;
+
+/**
+ * The winners of the vertices solved so far, winning a vertex also wins its attractor.
+ *
+ * @winner is the player winning a vertex, 0 for even, 1 for odd and -1 if it is not solved yet.
+ * @remaining holds per player the number of successors of a vertex not won by that player.
+ */
+class WinnerAttractor {
+public:
+    WinnerAttractor(const ParityGame& game) :
+        m_game(game),
+        m_winner(game.getNumberOfVertices(), -1)
+    {
+        for (int player = 0; player < 2; ++player) {
+            m_remaining[player].resize(game.getNumberOfVertices());
+            for (Vertex vertex = 0; vertex < game.getNumberOfVertices(); ++vertex) {
+                m_remaining[player][vertex] = game.getOutgoingVertices(vertex).size();
+            }
+        }
+    }
+
+    /**
+     * Sets the winner of an unsolved vertex and every vertex it attracts.
+     */
+    void setWinner(Vertex vertex, int player)
+    {
+        if (m_winner[vertex] >= 0) {
+            return;
+        }
+
+        m_winner[vertex] = player;
+        std::vector<Vertex> attracted = { vertex };
+        while (!attracted.empty()) {
+            Vertex current = attracted.back();
+            attracted.pop_back();
+
+            for (auto predecessor : m_game.getIncomingVertices(current)) {
+                if (m_winner[predecessor] >= 0) {
+                    continue;
+                }
+
+                // The owner moves to the won vertex, its opponent once it has no other choice.
+                if ((m_game.isEven(predecessor) ? 0 : 1) == player || --m_remaining[player][predecessor] == 0) {
+                    m_winner[predecessor] = player;
+                    attracted.push_back(predecessor);
+                }
+            }
+        }
+    }
+
+    int getWinner(Vertex vertex) const { return m_winner[vertex]; }
+
+private:
+    const ParityGame& m_game;
+    std::vector<int> m_winner;
+    std::vector<size_t> m_remaining[2];
+};
+
+/**
+ * Returns the subgame consisting of vertices, where index maps every vertex of the game to its index
+ * in vertices or NO_VERTEX. Priorities are compressed: gaps are removed and successive priorities
+ * of the same parity are merged, the lowest priority stays even or odd.
+ */
+static ParityGame createSubgame(const ParityGame& game, const std::vector<Vertex>& vertices, const std::vector<Vertex>& index)
+{
+    std::set<int> priorities;
+    for (auto vertex : vertices) {
+        priorities.insert(game.getPriority(vertex));
+    }
+
+    std::map<int, int> compressed;
+    int current = *priorities.begin() % 2;
+    for (auto priority : priorities) {
+        if (priority % 2 != current % 2) {
+            ++current;
+        }
+        compressed[priority] = current;
+    }
+
+    std::vector<int> owner(vertices.size());
+    std::vector<int> priority(vertices.size());
+    std::vector<Vertex> edgeSources;
+    std::vector<Vertex> edgeTargets;
+
+    for (Vertex local = 0; local < vertices.size(); ++local) {
+        Vertex vertex = vertices[local];
+        owner[local] = game.isEven(vertex) ? 0 : 1;
+        priority[local] = compressed[game.getPriority(vertex)];
+
+        for (auto successor : game.getOutgoingVertices(vertex)) {
+            if (index[successor] != NO_VERTEX) {
+                edgeSources.push_back(local);
+                edgeTargets.push_back(index[successor]);
+            }
+        }
+    }
+
+    return ParityGame(std::move(owner), std::move(priority), std::move(edgeSources), std::move(edgeTargets));
+}
+
+/**
+ * Wins a vertex with a self-loop for its owner if the owner is favoured by its priority, or if it has no other choice.
+ */
+static void solveSelfLoop(const ParityGame& game, WinnerAttractor& winners, Vertex vertex)
+{
+    int player = game.getPriority(vertex) % 2;
+
+    if (game.hasEdge(vertex, vertex) && ((game.isEven(vertex) ? 0 : 1) == player || game.getOutgoingVertices(vertex).size() == 1)) {
+        winners.setWinner(vertex, player);
+    }
+}
+
+/**
+ * Stores the unsolved vertices of a component whose successor components are solved in vertices, and
+ * returns whether they form a subgame that needs to be solved by a solver.
+ */
+static bool gatherSubgame(const ParityGame& game, WinnerAttractor& winners, const std::vector<Vertex>& component, std::vector<Vertex>& vertices)
+{
+    vertices.clear();
+    for (auto vertex : component) {
+        if (winners.getWinner(vertex) < 0) {
+            vertices.push_back(vertex);
+        }
+    }
+
+    if (vertices.empty()) {
+        return false;
+    }
+
+    bool singleParity = true;
+    for (auto vertex : vertices) {
+        singleParity = singleParity && !game.getOutgoingVertices(vertex).empty()
+            && game.getPriority(vertex) % 2 == game.getPriority(vertices.front()) % 2;
+    }
+
+    if (singleParity) {
+        // Every play stays in the subgame, so the only parity occurring in it decides the winner.
+        for (auto vertex : vertices) {
+            winners.setWinner(vertex, game.getPriority(vertex) % 2);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<std::vector<Vertex>> decomposeComponents(const ParityGame& game)
+{
+    // Tarjan's algorithm, with an explicit stack of the vertices being visited and their next successor.
+    size_t numVertices = game.getNumberOfVertices();
+    std::vector<Vertex> order(numVertices, NO_VERTEX);
+    std::vector<Vertex> lowest(numVertices);
+    std::vector<bool> onStack(numVertices, false);
+    std::vector<Vertex> stack;
+    std::vector<std::pair<Vertex, const Vertex*>> visiting;
+    std::vector<std::vector<Vertex>> components;
+    Vertex visited = 0;
+
+    for (Vertex root = 0; root < numVertices; ++root) {
+        if (order[root] != NO_VERTEX) {
+            continue;
+        }
+
+        order[root] = lowest[root] = visited++;
+        stack.push_back(root);
+        onStack[root] = true;
+        visiting.emplace_back(root, game.getOutgoingVertices(root).begin());
+
+        while (!visiting.empty()) {
+            Vertex vertex = visiting.back().first;
+            if (visiting.back().second != game.getOutgoingVertices(vertex).end()) {
+                Vertex successor = *visiting.back().second++;
+
+                if (order[successor] == NO_VERTEX) {
+                    order[successor] = lowest[successor] = visited++;
+                    stack.push_back(successor);
+                    onStack[successor] = true;
+                    visiting.emplace_back(successor, game.getOutgoingVertices(successor).begin());
+                }
+                else if (onStack[successor]) {
+                    lowest[vertex] = std::min(lowest[vertex], order[successor]);
+                }
+                continue;
+            }
+
+            visiting.pop_back();
+            if (!visiting.empty()) {
+                Vertex parent = visiting.back().first;
+                lowest[parent] = std::min(lowest[parent], lowest[vertex]);
+            }
+
+            if (lowest[vertex] == order[vertex]) {
+                // The vertex is the root of a component, consisting of the vertices above it on the stack.
+                std::vector<Vertex> component;
+                Vertex member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    component.push_back(member);
+                } while (member != vertex);
+
+                components.push_back(component);
+            }
+        }
+    }
+
+    return components;
+}
+
+/**
+ * Returns the level of every component in the condensation of the game, where components without
+ * successors in other components have level 0 and other components lie one above their highest successor.
+ */
+static std::vector<size_t> getComponentLevels(const ParityGame& game, const std::vector<std::vector<Vertex>>& components)
+{
+    std::vector<size_t> componentOf(game.getNumberOfVertices());
+    for (size_t component = 0; component < components.size(); ++component) {
+        for (auto vertex : components[component]) {
+            componentOf[vertex] = component;
+        }
+    }
+
+    // The successor components of a component are listed before it.
+    std::vector<size_t> levels(components.size(), 0);
+    for (size_t component = 0; component < components.size(); ++component) {
+        for (auto vertex : components[component]) {
+            for (auto successor : game.getOutgoingVertices(vertex)) {
+                if (componentOf[successor] != component) {
+                    levels[component] = std::max(levels[component], levels[componentOf[successor]] + 1);
+                }
+            }
+        }
+    }
+
+    return levels;
+}
+
+std::vector<bool> solvePreprocessed(const ParityGame& game, const GameSolver& solver, unsigned numThreads)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    WinnerAttractor winners(game);
+
+    for (Vertex vertex = 0; vertex < game.getNumberOfVertices(); ++vertex) {
+        solveSelfLoop(game, winners, vertex);
+    }
+
+    std::vector<std::vector<Vertex>> components = decomposeComponents(game);
+    std::vector<size_t> levels = getComponentLevels(game, components);
+
+    std::vector<std::vector<size_t>> componentsAtLevel;
+    for (size_t component = 0; component < components.size(); ++component) {
+        if (levels[component] >= componentsAtLevel.size()) {
+            componentsAtLevel.resize(levels[component] + 1);
+        }
+        componentsAtLevel[levels[component]].push_back(component);
+    }
+
+    std::vector<Vertex> index(game.getNumberOfVertices(), NO_VERTEX);
+    for (const auto& level : componentsAtLevel) {
+        // Gather the unsolved vertices of the components at this level, which have no edges between them.
+        std::vector<std::vector<Vertex>> subgames;
+        for (auto component : level) {
+            std::vector<Vertex> vertices;
+            if (!gatherSubgame(game, winners, components[component], vertices)) {
+                continue;
+            }
+
+            for (Vertex local = 0; local < vertices.size(); ++local) {
+                index[vertices[local]] = local;
+            }
+            subgames.push_back(vertices);
+        }
+
+        // Solve the subgames on a pool of threads, a single subgame gets all threads for itself.
+        std::vector<std::vector<bool>> evenWins(subgames.size());
+        std::atomic<size_t> nextSubgame(0);
+        unsigned solverThreads = (subgames.size() == 1) ? numThreads : 1;
+
+        auto worker = [&]() {
+            for (size_t subgame = nextSubgame++; subgame < subgames.size(); subgame = nextSubgame++) {
+                evenWins[subgame] = solver(createSubgame(game, subgames[subgame], index), solverThreads);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t thread = 1; thread < std::min<size_t>(numThreads, subgames.size()); ++thread) {
+            threads.push_back(std::thread(worker));
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (size_t subgame = 0; subgame < subgames.size(); ++subgame) {
+            const std::vector<Vertex>& vertices = subgames[subgame];
+            for (Vertex local = 0; local < vertices.size(); ++local) {
+                index[vertices[local]] = NO_VERTEX;
+                winners.setWinner(vertices[local], evenWins[subgame][local] ? 0 : 1);
+            }
+        }
+    }
+
+    std::vector<bool> evenDominated(game.getNumberOfVertices());
+    for (Vertex vertex = 0; vertex < evenDominated.size(); ++vertex) {
+        evenDominated[vertex] = (winners.getWinner(vertex) == 0);
+    }
+    return evenDominated;
+}
+
+bool solveLocally(const ParityGame& game, Vertex target, const GameSolver& solver, unsigned numThreads)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    WinnerAttractor winners(game);
+
+    // Tarjan's algorithm from the target, as in decomposeComponents, where every component is solved
+    // as soon as it is found. Solved vertices are not explored any further.
+    size_t numVertices = game.getNumberOfVertices();
+    std::vector<Vertex> order(numVertices, NO_VERTEX);
+    std::vector<Vertex> lowest(numVertices);
+    std::vector<bool> onStack(numVertices, false);
+    std::vector<Vertex> stack;
+    std::vector<std::pair<Vertex, const Vertex*>> visiting;
+    std::vector<Vertex> index(numVertices, NO_VERTEX);
+    Vertex visited = 0;
+
+    auto visit = [&](Vertex vertex) {
+        order[vertex] = lowest[vertex] = visited++;
+        stack.push_back(vertex);
+        onStack[vertex] = true;
+        visiting.emplace_back(vertex, game.getOutgoingVertices(vertex).begin());
+        solveSelfLoop(game, winners, vertex);
+    };
+
+    visit(target);
+    while (!visiting.empty() && winners.getWinner(target) < 0) {
+        Vertex vertex = visiting.back().first;
+        if (winners.getWinner(vertex) < 0 && visiting.back().second != game.getOutgoingVertices(vertex).end()) {
+            Vertex successor = *visiting.back().second++;
+
+            if (winners.getWinner(successor) >= 0) {
+                continue;
+            }
+
+            if (order[successor] == NO_VERTEX) {
+                visit(successor);
+            }
+            else if (onStack[successor]) {
+                lowest[vertex] = std::min(lowest[vertex], order[successor]);
+            }
+            continue;
+        }
+
+        visiting.pop_back();
+        if (!visiting.empty()) {
+            Vertex parent = visiting.back().first;
+            lowest[parent] = std::min(lowest[parent], lowest[vertex]);
+        }
+
+        if (lowest[vertex] == order[vertex]) {
+            std::vector<Vertex> component;
+            Vertex member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                component.push_back(member);
+            } while (member != vertex);
+
+            // The unsolved vertices explored all their successors, which lie in this component or are solved.
+            std::vector<Vertex> vertices;
+            if (gatherSubgame(game, winners, component, vertices)) {
+                for (Vertex local = 0; local < vertices.size(); ++local) {
+                    index[vertices[local]] = local;
+                }
+
+                std::vector<bool> evenWins = solver(createSubgame(game, vertices, index), numThreads);
+                for (Vertex local = 0; local < vertices.size(); ++local) {
+                    index[vertices[local]] = NO_VERTEX;
+                    winners.setWinner(vertices[local], evenWins[local] ? 0 : 1);
+                }
+            }
+        }
+    }
+
+    return winners.getWinner(target) == 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_PREPROCESSING_H_
+#define TOOL_PREPROCESSING_H_
+
+#include "ParityGame.h"
+
+#include <functional>
+#include <vector>
+
+/**
+ * A solver for a complete parity game on the given number of threads, returning true for every
+ * vertex won by even. It may be called from multiple threads at once.
+ */
+typedef std::function<std::vector<bool>(const ParityGame&, unsigned)> GameSolver;
+
+/**
+ * Returns the strongly connected components of the game, every component is listed after all
+ * components reachable from it, such that the first component has no successors in other components.
+ */
+std::vector<std::vector<Vertex>> decomposeComponents(const ParityGame& game);
+
+/**
+ * Solves the given parity game after reducing it, returning true for every vertex won by even.
+ *
+ * First every vertex with a self-loop that its owner wins by staying forever is won, together with
+ * its attractor. The remaining game is decomposed into strongly connected components that are
+ * solved bottom-up: the unsolved vertices of a component form a subgame, as every one of them has a
+ * successor in it and its other successors are won by its opponent. After its priorities are
+ * compressed, that subgame is solved by solver unless it only has one priority, and its winning
+ * regions are attracted into the components above it.
+ *
+ * Components at the same level of the condensation, the longest path to a bottom component, have
+ * no edges between them and are solved in parallel on numThreads threads, 0 for the number of cores.
+ */
+std::vector<bool> solvePreprocessed(const ParityGame& game, const GameSolver& solver, unsigned numThreads);
+
+/**
+ * Returns whether even wins the target vertex, with the same reductions as solvePreprocessed but only
+ * for the part of the game that is needed.
+ *
+ * The components are found by a depth-first search from the target, and each one is solved as soon
+ * as it is complete. Solved vertices are not explored further, and the search stops once the target
+ * is won, so components that cannot influence the target are never solved. Every subgame is solved
+ * on numThreads threads, 0 for the number of cores.
+ */
+bool solveLocally(const ParityGame& game, Vertex target, const GameSolver& solver, unsigned numThreads);
+
+#endif // TOOL_PREPROCESSING_H_
@@ -0,0 +1,282 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PromotionSolver.h"
+
+#include <algorithm>
+
+/**
+ * The state of the priority promotion search.
+ *
+ * Lower priorities are more significant, as the lowest priority that occurs infinitely often
+ * decides the winner.
+ *
+ * @alive indicates the vertices not yet won by a player.
+ * @region maps a vertex to the priority of the region it is assigned to.
+ * @regions holds per priority the vertices assigned to it, possibly with vertices that have been
+ * assigned elsewhere since.
+ * @attracted, @counted, @counters hold the attractor computation that last attracted or counted a
+ * vertex and the number of successors of an opponent vertex that are not attracted yet.
+ * @winner is the player winning a vertex, 0 for even and 1 for odd.
+ */
+class PromotionSearch {
+public:
+    PromotionSearch(const ParityGame& game, PromotionStatistics& statistics) :
+        m_game(game),
+        m_statistics(statistics),
+        m_alive(game.getNumberOfVertices(), true),
+        m_region(game.getNumberOfVertices()),
+        m_attracted(game.getNumberOfVertices(), 0),
+        m_counted(game.getNumberOfVertices(), 0),
+        m_counters(game.getNumberOfVertices(), 0),
+        m_attractorCount(0),
+        m_winner(game.getNumberOfVertices(), 0)
+    {
+        int maxPriority = 0;
+        for (Vertex vertex = 0; vertex < game.getNumberOfVertices(); ++vertex) {
+            maxPriority = std::max(maxPriority, game.getPriority(vertex));
+        }
+
+        m_verticesWithPriority.resize(maxPriority + 1);
+        for (Vertex vertex = 0; vertex < game.getNumberOfVertices(); ++vertex) {
+            m_verticesWithPriority[game.getPriority(vertex)].push_back(vertex);
+        }
+        m_regions.resize(maxPriority + 1);
+    }
+
+    /**
+     * Removes dominions from the game until every vertex is won.
+     */
+    void solve()
+    {
+        size_t remaining = m_game.getNumberOfVertices();
+        while (remaining > 0) {
+            int player = 0;
+            std::vector<Vertex> dominion = searchDominion(player);
+            ++m_statistics.dominions;
+
+            // The attractor of a dominion is won by the same player.
+            attract(player, dominion, [this](Vertex vertex) { return m_alive[vertex]; });
+            for (auto vertex : dominion) {
+                m_alive[vertex] = false;
+                m_winner[vertex] = player;
+            }
+            remaining -= dominion.size();
+        }
+    }
+
+    int getWinner(Vertex vertex) const { return m_winner[vertex]; }
+
+private:
+    /**
+     * Returns a dominion of the remaining game, won by player.
+     */
+    std::vector<Vertex> searchDominion(int& player)
+    {
+        // Every vertex starts in the region of its own priority.
+        int priority = -1;
+        for (int current = 0; current < int(m_regions.size()); ++current) {
+            resetRegion(current, -1);
+            if (priority < 0 && !m_regions[current].empty()) {
+                priority = current;
+            }
+        }
+
+        while (true) {
+            ++m_statistics.queries;
+            player = priority % 2;
+
+            // The region is the attractor to the vertices assigned to the priority, within the
+            // vertices assigned to it or a less significant priority.
+            std::vector<Vertex> region;
+            for (auto vertex : m_regions[priority]) {
+                if (m_alive[vertex] && m_region[vertex] == priority) {
+                    region.push_back(vertex);
+                }
+            }
+            attract(player, region, [this, priority](Vertex vertex) {
+                return m_alive[vertex] && m_region[vertex] >= priority;
+            });
+            for (auto vertex : region) {
+                m_region[vertex] = priority;
+            }
+            m_regions[priority] = region;
+
+            int escape = -1;
+            if (isOpen(player, priority, region, escape)) {
+                // Continue with the next less significant region.
+                priority = nextPriority(priority);
+            }
+            else if (escape < 0) {
+                return region;
+            }
+            else {
+                // The opponent can only escape to more significant regions, so join the closest.
+                ++m_statistics.promotions;
+                for (auto vertex : region) {
+                    m_region[vertex] = escape;
+                }
+                m_regions[escape].insert(m_regions[escape].end(), region.begin(), region.end());
+
+                for (int current = escape + 1; current < int(m_regions.size()); ++current) {
+                    resetRegion(current, escape);
+                }
+
+                priority = escape;
+            }
+        }
+    }
+
+    /**
+     * Returns whether the opponent of player can leave the region, or player is forced to, within
+     * the vertices assigned to priority or a less significant one. Otherwise escape is set to the
+     * least significant priority the opponent can escape to, or -1 if the region cannot be left.
+     */
+    bool isOpen(int player, int priority, const std::vector<Vertex>& region, int& escape)
+    {
+        for (auto vertex : region) {
+            bool opponent = (m_game.isEven(vertex) ? 0 : 1) != player;
+            bool staysInside = false;
+
+            for (auto successor : m_game.getOutgoingVertices(vertex)) {
+                if (!m_alive[successor]) {
+                    continue;
+                }
+
+                if (m_region[successor] == priority) {
+                    staysInside = true;
+                }
+                else if (opponent) {
+                    if (m_region[successor] > priority) {
+                        return true;
+                    }
+                    escape = std::max(escape, m_region[successor]);
+                }
+            }
+
+            if (!opponent && !staysInside) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Returns the least priority more than priority that has a vertex assigned to it.
+     */
+    int nextPriority(int priority) const
+    {
+        for (int current = priority + 1; current < int(m_regions.size()); ++current) {
+            for (auto vertex : m_regions[current]) {
+                if (m_alive[vertex] && m_region[vertex] == current) {
+                    return current;
+                }
+            }
+        }
+
+        return -1; // An open region always has a less significant region to escape to.
+    }
+
+    /**
+     * Assigns the remaining vertices with the given priority to the region of that priority, except
+     * the ones in a region of at most the given bound.
+     */
+    void resetRegion(int priority, int bound)
+    {
+        m_regions[priority].clear();
+        for (auto vertex : m_verticesWithPriority[priority]) {
+            if (m_alive[vertex] && m_region[vertex] > bound) {
+                m_region[vertex] = priority;
+                m_regions[priority].push_back(vertex);
+            }
+        }
+    }
+
+    /**
+     * Extends target to the attractor of player within the vertices for which inside holds.
+     */
+    template <typename Inside>
+    void attract(int player, std::vector<Vertex>& target, Inside inside)
+    {
+        unsigned current = ++m_attractorCount;
+        for (auto vertex : target) {
+            m_attracted[vertex] = current;
+        }
+
+        for (size_t index = 0; index < target.size(); ++index) {
+            for (auto predecessor : m_game.getIncomingVertices(target[index])) {
+                if (m_attracted[predecessor] == current || !inside(predecessor)) {
+                    continue;
+                }
+
+                if ((m_game.isEven(predecessor) ? 0 : 1) != player) {
+                    if (m_counted[predecessor] != current) {
+                        // Count the successors of the opponent vertex within the subgame.
+                        m_counted[predecessor] = current;
+                        m_counters[predecessor] = 0;
+                        for (auto successor : m_game.getOutgoingVertices(predecessor)) {
+                            if (inside(successor)) {
+                                ++m_counters[predecessor];
+                            }
+                        }
+                    }
+
+                    if (--m_counters[predecessor] > 0) {
+                        continue;
+                    }
+                }
+
+                m_attracted[predecessor] = current;
+                target.push_back(predecessor);
+            }
+        }
+    }
+
+    const ParityGame& m_game;
+    PromotionStatistics& m_statistics;
+
+    std::vector<bool> m_alive;
+    std::vector<int> m_region;
+    std::vector<std::vector<Vertex>> m_regions;
+    std::vector<std::vector<Vertex>> m_verticesWithPriority;
+
+    std::vector<unsigned> m_attracted;
+    std::vector<unsigned> m_counted;
+    std::vector<size_t> m_counters;
+    unsigned m_attractorCount;
+
+    std::vector<int> m_winner;
+};
+
+std::vector<bool> solveParityGamePromotion(const ParityGame& game, bool fullPartition, PromotionStatistics& statistics)
+{
+    statistics.queries = statistics.promotions = statistics.dominions = 0;
+
+    PromotionSearch search(game, statistics);
+    search.solve();
+
+    if (fullPartition) {
+        std::vector<bool> evenDominated(game.getNumberOfVertices());
+        for (Vertex vertex = 0; vertex < evenDominated.size(); ++vertex) {
+            evenDominated[vertex] = (search.getWinner(vertex) == 0);
+        }
+        return evenDominated;
+    }
+    else {
+        return{ search.getWinner(0) == 0 };
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_PROMOTIONSOLVER_H_
+#define TOOL_PROMOTIONSOLVER_H_
+
+#include "ParityGame.h"
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * The amount of work done by the priority promotion solver.
+ *
+ * @queries, the number of regions computed while searching for dominions.
+ * @promotions, the number of regions that were merged into a more significant region.
+ * @dominions, the number of dominions found.
+ */
+struct PromotionStatistics {
+    size_t queries;
+    size_t promotions;
+    size_t dominions;
+};
+
+/**
+ * Solves the given parity game with priority promotion.
+ *
+ * Starting from the lowest priority, every priority p gets a region: the attractor, for the player
+ * p favours, to the vertices assigned to p, within the vertices assigned to p or a less significant
+ * priority. If the opponent can leave the region to a less significant part, the search continues
+ * with the next priority. If the opponent can only leave to more significant regions, the region is
+ * promoted to the closest of those and the less significant regions are reset. A region that
+ * cannot be left at all is a dominion, whose attractor is removed from the game before searching
+ * the remainder. Every vertex is assumed to have a successor.
+ *
+ * @param[in] fullPartition Indicate that the vector contains true|false for every vertex, otherwise only for vertex 0.
+ * @param[out] statistics The number of queries, promotions and dominions of the search.
+ */
+std::vector<bool> solveParityGamePromotion(const ParityGame& game, bool fullPartition, PromotionStatistics& statistics);
+
+#endif // TOOL_PROMOTIONSOLVER_H_
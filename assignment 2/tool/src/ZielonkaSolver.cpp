@@ -0,0 +1,240 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ZielonkaSolver.h"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+/**
+ * The state shared by the recursive calls of Zielonka's algorithm.
+ *
+ * @inGame indicates the vertices of the current subgame.
+ * @attracted, @counted hold the attractor computation that last attracted or counted a vertex.
+ * @counters is the number of successors of an opponent vertex that are not attracted yet.
+ * @winner is the player winning a vertex, 0 for even and 1 for odd.
+ */
+struct ZielonkaState {
+    const ParityGame& game;
+    std::vector<bool> inGame;
+    std::vector<unsigned> attracted;
+    std::vector<unsigned> counted;
+    std::vector<size_t> counters;
+    unsigned attractorCount;
+    std::vector<int> winner;
+
+    ZielonkaState(const ParityGame& game) :
+        game(game),
+        inGame(game.getNumberOfVertices(), true),
+        attracted(game.getNumberOfVertices(), 0),
+        counted(game.getNumberOfVertices(), 0),
+        counters(game.getNumberOfVertices(), 0),
+        attractorCount(0),
+        winner(game.getNumberOfVertices(), 0)
+    {}
+};
+
+/**
+ * Extends target to the attractor of player within the current subgame.
+ *
+ * An opponent vertex is attracted once all its successors in the subgame are, which is tracked by
+ * counting down its number of remaining successors instead of checking them all again.
+ */
+static void attract(ZielonkaState& state, int player, std::vector<Vertex>& target)
+{
+    unsigned current = ++state.attractorCount;
+    for (auto vertex : target) {
+        state.attracted[vertex] = current;
+    }
+
+    for (size_t index = 0; index < target.size(); ++index) {
+        for (auto predecessor : state.game.getIncomingVertices(target[index])) {
+            if (!state.inGame[predecessor] || state.attracted[predecessor] == current) {
+                continue;
+            }
+
+            if ((state.game.isEven(predecessor) ? 0 : 1) != player) {
+                if (state.counted[predecessor] != current) {
+                    // Count the successors of the opponent vertex within the subgame.
+                    state.counted[predecessor] = current;
+                    state.counters[predecessor] = 0;
+                    for (auto successor : state.game.getOutgoingVertices(predecessor)) {
+                        if (state.inGame[successor]) {
+                            ++state.counters[predecessor];
+                        }
+                    }
+                }
+
+                if (--state.counters[predecessor] > 0) {
+                    continue;
+                }
+            }
+
+            state.attracted[predecessor] = current;
+            target.push_back(predecessor);
+        }
+    }
+}
+
+/**
+ * Removes the vertices from the current subgame and appends them to removed.
+ */
+static void removeVertices(ZielonkaState& state, const std::vector<Vertex>& vertices, std::vector<Vertex>& removed)
+{
+    for (auto vertex : vertices) {
+        state.inGame[vertex] = false;
+    }
+    removed.insert(removed.end(), vertices.begin(), vertices.end());
+}
+
+/**
+ * A subgame that is being solved, with the state of its loop that is kept while its subgame without
+ * the attractor of the lowest priority is solved.
+ *
+ * @vertices are the vertices of the subgame that are not won yet, which are the ones marked in inGame.
+ * @removed are the vertices won by the opponent of the player favoured by the lowest priority so far.
+ * @attractor, @subgame and @player are those of the current iteration of the loop.
+ * @solvingSubgame indicates that the frame above this one solves subgame.
+ */
+struct ZielonkaFrame {
+    std::vector<Vertex> vertices;
+    std::vector<Vertex> removed;
+    std::vector<Vertex> attractor;
+    std::vector<Vertex> subgame;
+    int player;
+    bool solvingSubgame;
+
+    explicit ZielonkaFrame(std::vector<Vertex> vertices) :
+        vertices(std::move(vertices)),
+        player(0),
+        solvingSubgame(false)
+    {}
+};
+
+/**
+ * Solves the subgame consisting of vertices, which must be the vertices marked in inGame, and
+ * stores the winner of every vertex.
+ *
+ * The second recursive call of the algorithm is replaced by a loop, and the first one by pushing a
+ * frame on an explicit stack. The depth of the stack is bounded by the number of distinct priorities,
+ * which can be as large as the number of vertices, so it is not kept on the call stack.
+ */
+static void solve(ZielonkaState& state, std::vector<Vertex> vertices)
+{
+    const ParityGame& game = state.game;
+    std::vector<ZielonkaFrame> frames;
+    frames.push_back(ZielonkaFrame(std::move(vertices)));
+
+    while (!frames.empty()) {
+        ZielonkaFrame& frame = frames.back();
+
+        if (frame.solvingSubgame) {
+            // The subgame without the attractor has been solved.
+            frame.solvingSubgame = false;
+            for (auto vertex : frame.attractor) {
+                state.inGame[vertex] = true;
+            }
+
+            std::vector<Vertex> opponentWon;
+            for (auto vertex : frame.subgame) {
+                if (state.winner[vertex] != frame.player) {
+                    opponentWon.push_back(vertex);
+                }
+            }
+
+            if (opponentWon.empty()) {
+                // The player wins the whole subgame.
+                for (auto vertex : frame.vertices) {
+                    state.winner[vertex] = frame.player;
+                }
+                frame.vertices.clear();
+                continue;
+            }
+
+            // The opponent wins its attractor to its winning region, continue with the remainder.
+            attract(state, 1 - frame.player, opponentWon);
+            for (auto vertex : opponentWon) {
+                state.winner[vertex] = 1 - frame.player;
+            }
+            removeVertices(state, opponentWon, frame.removed);
+
+            frame.vertices.erase(std::remove_if(frame.vertices.begin(), frame.vertices.end(),
+                [&state](Vertex vertex) { return !state.inGame[vertex]; }), frame.vertices.end());
+            continue;
+        }
+
+        if (frame.vertices.empty()) {
+            for (auto vertex : frame.removed) {
+                state.inGame[vertex] = true;
+            }
+            frames.pop_back();
+            continue;
+        }
+
+        // The lowest priority decides which player it favours.
+        int lowest = INT_MAX;
+        for (auto vertex : frame.vertices) {
+            lowest = std::min(lowest, game.getPriority(vertex));
+        }
+        frame.player = lowest % 2;
+
+        frame.attractor.clear();
+        for (auto vertex : frame.vertices) {
+            if (game.getPriority(vertex) == lowest) {
+                frame.attractor.push_back(vertex);
+            }
+        }
+        attract(state, frame.player, frame.attractor);
+
+        // Solve the subgame without the attractor.
+        frame.subgame.clear();
+        for (auto vertex : frame.attractor) {
+            state.inGame[vertex] = false;
+        }
+        for (auto vertex : frame.vertices) {
+            if (state.inGame[vertex]) {
+                frame.subgame.push_back(vertex);
+            }
+        }
+
+        frame.solvingSubgame = true;
+        std::vector<Vertex> subgame = frame.subgame;
+        frames.push_back(ZielonkaFrame(std::move(subgame))); // Invalidates frame.
+    }
+}
+
+std::vector<bool> solveParityGameZielonka(const ParityGame& game, bool fullPartition)
+{
+    ZielonkaState state(game);
+
+    std::vector<Vertex> vertices(game.getNumberOfVertices());
+    for (Vertex vertex = 0; vertex < vertices.size(); ++vertex) {
+        vertices[vertex] = vertex;
+    }
+    solve(state, vertices);
+
+    if (fullPartition) {
+        std::vector<bool> evenDominated(game.getNumberOfVertices());
+        for (Vertex vertex = 0; vertex < evenDominated.size(); ++vertex) {
+            evenDominated[vertex] = (state.winner[vertex] == 0);
+        }
+        return evenDominated;
+    }
+    else {
+        return{ state.winner[0] == 0 };
+    }
+}
@@ -0,0 +1,34 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOOL_ZIELONKASOLVER_H_
+#define TOOL_ZIELONKASOLVER_H_
+
+#include "ParityGame.h"
+
+#include <vector>
+
+/**
+ * Solves the given parity game with Zielonka's recursive algorithm.
+ *
+ * The lowest priority of a subgame is attracted to by the player it favours, and the remainder is
+ * solved recursively. Every vertex is assumed to have a successor.
+ *
+ * @param[in] fullPartition Indicate that the vector contains true|false for every vertex, otherwise only for vertex 0.
+ */
+std::vector<bool> solveParityGameZielonka(const ParityGame& game, bool fullPartition);
+
+#endif // TOOL_ZIELONKASOLVER_H_
@@ -0,0 +1,290 @@
+/**
+ * Copyright 2016 Algorithms for Model Checking.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "BenchmarkHarness.h"
+#include "LiftingStrategy.h"
+#include "PGParser.h"
+#include "PGSolver.h"
+#include "Preprocessing.h"
+#include "PromotionSolver.h"
+#include "ZielonkaSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * A parity game of a testcase family.
+ *
+ * @expectedWinner is the winner of vertex 0 in the verdicts.txt of the family, 0 for even, 1 for
+ * odd and -1 if the family has no verdict for the game. @even and @odd are the vertices it lists
+ * for either player.
+ */
+struct Instance {
+    std::string family;
+    std::string game;
+    int expectedWinner;
+    std::vector<Vertex> even;
+    std::vector<Vertex> odd;
+};
+
+/**
+ * How a game is solved, with the options of the tool.
+ */
+struct Configuration {
+    std::string solver;
+    std::string order;
+    unsigned numThreads;
+    bool preprocess;
+    bool fullPartition;
+};
+
+/**
+ * Reads the vertices of the set following the keyword in the line, as in: even {0,1,3}.
+ */
+static std::vector<Vertex> readVertexSet(const std::string& line, const std::string& keyword)
+{
+    std::vector<Vertex> vertices;
+    size_t start = line.find(keyword);
+    if (start == std::string::npos || (start = line.find('{', start)) == std::string::npos) {
+        return vertices;
+    }
+
+    std::stringstream set(line.substr(start + 1, line.find('}', start) - start - 1));
+    std::string vertex;
+    while (std::getline(set, vertex, ',')) {
+        if (vertex.find_first_of("0123456789") != std::string::npos) {
+            vertices.push_back(std::stoul(vertex));
+        }
+    }
+    return vertices;
+}
+
+/**
+ * Collects every game of every family in the testcases directory, with the verdicts of the family.
+ * The verdicts.txt of a family has a line per game, as in: game01: even {0,1} odd {2,3}.
+ */
+static std::vector<Instance> collectInstances(const std::string& testcases, const std::vector<std::string>& families)
+{
+    std::vector<Instance> instances;
+    for (auto& family : listDirectory(testcases, true, "")) {
+        if (!families.empty() && std::find(families.begin(), families.end(), family) == families.end()) {
+            continue;
+        }
+
+        std::string path = testcases + "/" + family;
+        std::vector<std::string> lines;
+        std::ifstream verdicts(path + "/verdicts.txt");
+        for (std::string line; std::getline(verdicts, line);) {
+            lines.push_back(line);
+        }
+
+        for (auto& name : listDirectory(path, false, ".gm")) {
+            Instance instance = { family, path + "/" + name, -1, {}, {} };
+            std::string game = name.substr(0, name.size() - 3);
+
+            for (auto& line : lines) {
+                if (line.compare(0, game.size() + 1, game + ":") == 0) {
+                    instance.even = readVertexSet(line, "even");
+                    instance.odd = readVertexSet(line, "odd");
+                    if (std::find(instance.even.begin(), instance.even.end(), 0) != instance.even.end()) {
+                        instance.expectedWinner = 0;
+                    }
+                    else if (std::find(instance.odd.begin(), instance.odd.end(), 0) != instance.odd.end()) {
+                        instance.expectedWinner = 1;
+                    }
+                }
+            }
+            instances.push_back(instance);
+        }
+    }
+
+    return instances;
+}
+
+/**
+ * Loads the game and solves it as the tool does with the given configuration.
+ */
+static TrialResult solveInstance(const Instance& instance, const Configuration& configuration)
+{
+    TrialResult result = { -1, -1, 0, 0, -1 };
+    std::unique_ptr<LiftingStrategy> strategy = createLiftingStrategy(configuration.order);
+
+    auto start = std::chrono::steady_clock::now();
+    ParityGame game = parseParityGame(instance.game.c_str());
+    auto loaded = std::chrono::steady_clock::now();
+
+    LiftStatistics liftStatistics = { 0, 0 };
+    PromotionStatistics promotionStatistics = { 0, 0, 0 };
+    std::mutex statisticsMutex;
+    GameSolver solve = [&](const ParityGame& subgame, unsigned threads) {
+        std::vector<bool> winners;
+        if (configuration.solver == "zielonka") {
+            winners = solveParityGameZielonka(subgame, true);
+        }
+        else if (configuration.solver == "pp") {
+            PromotionStatistics statistics;
+            winners = solveParityGamePromotion(subgame, true, statistics);
+
+            std::lock_guard<std::mutex> lock(statisticsMutex);
+            promotionStatistics.queries += statistics.queries;
+        }
+        else {
+            LiftStatistics statistics;
+            if (threads == 1) {
+                winners = solveParityGame(subgame, *strategy, true, statistics);
+            }
+            else {
+                winners = solveParityGameParallel(subgame, *strategy, true, threads, statistics);
+            }
+
+            std::lock_guard<std::mutex> lock(statisticsMutex);
+            liftStatistics.lifts += statistics.lifts;
+        }
+        return winners;
+    };
+
+    std::vector<bool> evenWins;
+    if (!configuration.preprocess) {
+        evenWins = solve(game, configuration.numThreads);
+    }
+    else if (configuration.fullPartition) {
+        evenWins = solvePreprocessed(game, solve, configuration.numThreads);
+    }
+    else {
+        evenWins = { solveLocally(game, 0, solve, configuration.numThreads) };
+    }
+    auto solved = std::chrono::steady_clock::now();
+
+    result.verdict = evenWins[0] ? 0 : 1;
+    if (configuration.fullPartition && evenWins.size() > 1) {
+        // Vertices listed in the verdicts that the game does not have are skipped.
+        result.detailsMatch = 1;
+        for (auto vertex : instance.even) {
+            result.detailsMatch &= (vertex >= evenWins.size() || evenWins[vertex]) ? 1 : 0;
+        }
+        for (auto vertex : instance.odd) {
+            result.detailsMatch &= (vertex >= evenWins.size() || !evenWins[vertex]) ? 1 : 0;
+        }
+    }
+
+    if (configuration.solver == "pp") {
+        result.iterations = promotionStatistics.queries;
+    }
+    else if (configuration.solver != "zielonka") {
+        result.iterations = liftStatistics.lifts;
+    }
+    result.loadMilliseconds = std::chrono::duration<double, std::milli>(loaded - start).count();
+    result.solveMilliseconds = std::chrono::duration<double, std::milli>(solved - loaded).count();
+    return result;
+}
+
+/**
+ * Benchmarks the parity game solvers on every testcase family, as in:
+ * benchmark [--solver=S]... [--family=F]... [--order=O] [--threads=N] [--preprocess=on|off] [--output=winner|partition]
+ *     [--trials=N] [--warmup=N] [--timeout=S] [--format=csv|json] [--file=name] <testcases directory>
+ */
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> solvers;
+    Configuration configuration = { "spm", "input", 1, true, false };
+    BenchmarkOptions options;
+    bool validThreads = true;
+    std::string testcases;
+
+    for (int argIndex = 1; argIndex < argc; ++argIndex) {
+        std::string argument = argv[argIndex];
+        std::string value = argument.substr(argument.find('=') + 1);
+
+        if (parseBenchmarkOption(argument, options)) {
+            continue;
+        }
+
+        if (argument.find("--solver=") == 0) {
+            solvers.push_back(value);
+        }
+        else if (argument.find("--order=") == 0) {
+            configuration.order = value;
+        }
+        else if (argument.find("--threads=") == 0) {
+            validThreads = parseNumberOfThreads(value, configuration.numThreads) && validThreads;
+        }
+        else if (argument.find("--preprocess=") == 0) {
+            configuration.preprocess = (value != "off");
+        }
+        else if (argument.find("--output=") == 0) {
+            configuration.fullPartition = (value == "partition");
+        }
+        else {
+            testcases = argument;
+        }
+    }
+
+    for (auto& solver : solvers) {
+        if (solver != "spm" && solver != "zielonka" && solver != "pp") {
+            testcases.clear();
+        }
+    }
+    if (!validThreads) {
+        testcases.clear();
+    }
+
+    if (testcases.empty()) {
+        std::cout << "Usage: [--solver=spm|zielonka|pp]... [--family=<name>]... [--order=<lifting order>] [--threads=N] [--preprocess=on|off] "
+            "[--output=winner|partition] [--trials=N] [--warmup=N] [--timeout=S] [--format=csv|json] [--file=<filename>] <testcases directory>" << std::endl;
+        return -1;
+    }
+
+    if (createLiftingStrategy(configuration.order) == nullptr) {
+        std::cerr << "Unknown lifting order " << configuration.order << "\n";
+        return -1;
+    }
+
+    if (solvers.empty()) {
+        solvers.push_back("spm");
+    }
+    while (testcases.size() > 1 && testcases.back() == '/') {
+        testcases.pop_back();
+    }
+
+    std::vector<Column> columns = { { "family", false }, { "game", false }, { "solver", false }, { "order", false },
+        { "threads", true }, { "preprocess", false }, { "output", false } };
+
+    // Every game is solved by every solver before the next, so a wrong winner is reported early.
+    std::vector<BenchmarkRun> runs;
+    for (auto& instance : collectInstances(testcases, options.families)) {
+        for (auto& solver : solvers) {
+            configuration.solver = solver;
+            std::string game = instance.game.substr(testcases.size() + 1);
+            std::vector<std::string> values = { instance.family, game, solver, configuration.order,
+                std::to_string(configuration.numThreads), configuration.preprocess ? "on" : "off",
+                configuration.fullPartition ? "partition" : "winner" };
+
+            runs.push_back({ game + " using " + solver, values, instance.expectedWinner,
+                std::bind(solveInstance, instance, configuration) });
+        }
+    }
+
+    return runBenchmark(options, columns, runs, "winner", { "even", "odd" });
+}
@@ -14,50 +14,81 @@
  * limitations under the License.
  */
 
+#include "PGBinary.h"
 #include "PGParser.h"
 #include "PGSolver.h"
+#include "Preprocessing.h"
+#include "PromotionSolver.h"
+#include "ZielonkaSolver.h"
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string.h>
-#include <queue>
-#include <random>
-
-
-std::vector<Vertex> createIndegreeOrder(ParityGame game){
-	std::vector<Vertex> order;
-	//first get the max indegree
-	int maxIndegree = 0;
-	for (Vertex v = 0; v < game.getNumberOfVertices(); v++) {
-		size_t indegree = game.getIncomingVertices(v).size();
-		maxIndegree = (indegree > maxIndegree) ? indegree : maxIndegree;
-	}
-
-	//bucket sort
-	std::vector<std::set<Vertex>> degrees(maxIndegree + 1, std::set<Vertex>());
-	for (Vertex v = 0; v < game.getNumberOfVertices(); v++) {
-		degrees[game.getIncomingVertices(v).size()].insert(v);
-	}
-
-	//create the order
-	for (size_t i = degrees.size(); i-- > 0;) {
-		for (Vertex v : degrees[i]) {
-			order.push_back(v);
-		}
-	}
-
-	return order;
+
+/**
+ * Reads a parity game in .pgb format if the filename ends with .pgb, and in .gm format otherwise.
+ */
+static ParityGame loadParityGame(const char* strPgFilename)
+{
+    std::string filename = strPgFilename;
+    if (filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".pgb") == 0) {
+        return readBinaryParityGame(strPgFilename);
+    }
+    return parseParityGame(strPgFilename);
 }
 
+/**
+ * Converts a parity game to .pgb format, as in: convert [--without-predecessors] <input> <output.pgb>.
+ */
+static int convert(int argc, char* argv[])
+{
+    bool withPredecessors = true;
+    std::vector<const char*> filenames;
+    for (int argIndex = 2; argIndex < argc; ++argIndex) {
+        std::string argument = argv[argIndex];
+        if (argument == "--without-predecessors") {
+            withPredecessors = false;
+        }
+        else {
+            filenames.push_back(argv[argIndex]);
+        }
+    }
+
+    if (filenames.size() != 2) {
+        std::cout << "Usage: convert [--without-predecessors] <paritygame-filename> <pgb-filename>" << std::endl;
+        return -1;
+    }
+
+    try {
+        writeBinaryParityGame(loadParityGame(filenames[0]), filenames[1], withPredecessors);
+    }
+    catch (std::exception& exception) {
+        std::cerr << exception.what() << "\n";
+        return -1;
+    }
+
+    return 0;
+}
 
  /**
   * The main entry point for the program.
   */
 int main(int argc, char* argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "convert") == 0) {
+        return convert(argc, argv);
+    }
+
     // Input that might or should be specified.
-    int liftingOrder = 0;
+    std::string liftingOrder = "input";
+    int solver = 0; // 0 for small progress measures, 1 for zielonka, 2 for priority promotion.
+    unsigned numThreads = 1; // 0 for the number of cores.
+    bool preprocess = true;
     bool fullOutput = false;
+    bool printStatistics = false; // Print the lifts of spm or the promotions of pp.
+    bool validThreads = true;
     const char* strPgFilename = nullptr;
 
     // Parse the input string into order, output and filename.
@@ -65,21 +96,35 @@ int main(int argc, char* argv[])
         std::string argument = argv[argIndex];
 
         if (argument.find("--order=") != std::string::npos) {
-            if (argument.find("input") != std::string::npos) {
-                liftingOrder = 0;
+            liftingOrder = argument.substr(argument.find('=') + 1);
+        }
+        else if (argument.compare(0, 9, "--solver=") == 0) {
+            std::string name = argument.substr(9);
+            if (name == "spm") {
+                solver = 0;
             }
-            else if (argument.find("random") != std::string::npos) {
-                liftingOrder = 1;
+            else if (name == "zielonka") {
+                solver = 1;
             }
-            else if (argument.find("indegree") != std::string::npos) {
-                liftingOrder = 2;
+            else if (name == "pp") {
+                solver = 2;
             }
-            else if (argument.find("breadthfirst") != std::string::npos) {
-                liftingOrder = 3;
+            else {
+                solver = -1; // Unknown, the usage is printed.
+            }
+        }
+        else if (argument.find("--threads=") != std::string::npos) {
+            if (!parseNumberOfThreads(argument.substr(argument.find('=') + 1), numThreads)) {
+                validThreads = false; // The usage is printed.
+            }
+        }
+        else if (argument.find("--preprocess=") != std::string::npos) {
+            if (argument.find("on") != std::string::npos) {
+                preprocess = true;
+            }
+            else if (argument.find("off") != std::string::npos) {
+                preprocess = false;
             }
-			else if (argument.find("combi") != std::string::npos) {
-				liftingOrder = 4;
-			}
         }
         else if (argument.find("--output=") != std::string::npos) {
             if (argument.find("winner") != std::string::npos) {
@@ -89,101 +134,81 @@ int main(int argc, char* argv[])
                 fullOutput = true;
             }
         }
+        else if (argument == "--stats") {
+            printStatistics = true;
+        }
         else {
             strPgFilename = argv[argIndex];
         }
     }
 
-    // Check that all input was given.
-    if (argc < 2 || strPgFilename == nullptr) {
-        std::cout << "Usage: [--order=input|random|indegree|breadthfirst|combi] [--output=winner|partition] <paritygame-filename>" << std::endl;
+    // Check that all input was given and the solver and number of threads are valid.
+    if (argc < 2 || strPgFilename == nullptr || solver < 0 || !validThreads) {
+        std::cout << "Usage: [--solver=spm|zielonka|pp] [--threads=N] [--preprocess=on|off] [--order=input|random|indegree|breadthfirst|combi|priority|reverse-topological|focus] [--output=winner|partition] [--stats] <paritygame-filename>" << std::endl;
+        std::cout << "       convert [--without-predecessors] <paritygame-filename> <pgb-filename>" << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<LiftingStrategy> strategy = createLiftingStrategy(liftingOrder);
+    if (strategy == nullptr) {
+        std::cerr << "Unknown lifting order " << liftingOrder << "\n";
         return -1;
     }
 
     try {
-        ParityGame parityGame = parseParityGame(strPgFilename);
-
-        std::vector<Vertex> order;
-
-        switch (liftingOrder) {
-        case 0: {
-            order = std::vector<Vertex>(parityGame.getNumberOfVertices());
-            // Vertices are set such that order[i] = i.
-            Vertex vert = 0;
-            for (auto& next : order) {
-                next = vert;
-                ++vert;
-            }
-            break; 
-        }
-        case 1: {
-            // Vertices are handled such that order[i] = i.
-            order = std::vector<Vertex>(parityGame.getNumberOfVertices());
-            Vertex vert = 0;
-            for (auto& next : order) {
-                next = vert;
-                ++vert;
-            }
-            std::random_device rd;
-            std::default_random_engine engine(rd());
-            // Shuffle the order at random.
-            std::shuffle(order.begin(), order.end(), engine);
-            break;
-        }
-        case 2: {
-			order = createIndegreeOrder(parityGame);
-            break;
-        }
-        case 3: {
-            // Create the order and coloring vectors.
-            order = std::vector<Vertex>(parityGame.getNumberOfVertices(), -1);
-            std::vector<int> graphColoring(parityGame.getNumberOfVertices());
-
-            // The queue for to be handled vertices.
-            std::queue<Vertex> workQueue;
-
-            // The current order being search and vertex beind handled.
-            int ordering = 0;
-            Vertex currentVertex = 0;
-
-            while (ordering != parityGame.getNumberOfVertices()) {
-                workQueue.push(currentVertex); // Add the first vertex.
-
-                while (!workQueue.empty()) {
-                    // Pop the first element.
-                    Vertex current = workQueue.front();
-                    workQueue.pop();
-
-                    if (graphColoring[current] == 0) {
-                        // If the color is not yet set .
-                        for (auto& incomingVertex : parityGame.getIncomingVertices(current)) {
-                            workQueue.push(incomingVertex);
-                        }
-
-                        // Color the current vertex.
-                        graphColoring[current] = 1;
-                        order[ordering++] = current;
-                    }
+        ParityGame parityGame = loadParityGame(strPgFilename);
+
+        // Solve the parity game, the order only applies to small progress measures.
+        LiftStatistics liftStatistics = { 0, 0 };
+        PromotionStatistics statistics = { 0, 0, 0 };
+        std::mutex statisticsMutex;
+        GameSolver solve = [&](const ParityGame& game, unsigned threads) {
+            std::vector<bool> winners;
+            switch (solver) {
+            case 0: {
+                // Sum the lifts over all solved subgames.
+                LiftStatistics subgame;
+                if (threads == 1) {
+                    winners = solveParityGame(game, *strategy, true, subgame);
                 }
-
-                // Select the smallest vertex not yet put into ordering.
-                for (Vertex current = 0; current < graphColoring.size(); ++current) {
-                    if (graphColoring[current] == 0) {
-                        currentVertex = current;
-                        break;
-                    }
+                else {
+                    winners = solveParityGameParallel(game, *strategy, true, threads, subgame);
                 }
+
+                std::lock_guard<std::mutex> lock(statisticsMutex);
+                liftStatistics.lifts += subgame.lifts;
+                liftStatistics.increases += subgame.increases;
+                break;
             }
+            case 1:
+                winners = solveParityGameZielonka(game, true);
+                break;
+            case 2: {
+                // Sum the statistics over all solved subgames.
+                PromotionStatistics subgame;
+                winners = solveParityGamePromotion(game, true, subgame);
+
+                std::lock_guard<std::mutex> lock(statisticsMutex);
+                statistics.queries += subgame.queries;
+                statistics.promotions += subgame.promotions;
+                statistics.dominions += subgame.dominions;
+                break;
+            }
+            }
+            return winners;
+        };
+
+        // Only the part of the game that decides vertex 0 is solved when the partition is not printed.
+        std::vector<bool> result;
+        if (!preprocess) {
+            result = solve(parityGame, numThreads);
         }
-		case 4: 
-			//first het the indegree order
-			std::vector<Vertex> indegreeOrder = createIndegreeOrder(parityGame);
-			//breadth first search magic
-			break;
+        else if (fullOutput) {
+            result = solvePreprocessed(parityGame, solve, numThreads);
+        }
+        else {
+            result = { solveLocally(parityGame, 0, solve, numThreads) };
         }
-
-        // Solve the parity game.
-        std::vector<bool> result = solveParityGame(parityGame, order, fullOutput);
 
         // Print the output sets.
         if (fullOutput) {
@@ -211,6 +236,14 @@ int main(int argc, char* argv[])
                 std::cout << "Odd wins vertex 0" << std::endl;
             }
         }
+
+        if (printStatistics && solver == 0) {
+            std::cout << "Lifts: " << liftStatistics.lifts << ", increasing lifts: " << liftStatistics.increases << std::endl;
+        }
+        else if (printStatistics && solver == 2) {
+            std::cout << "Promotions: " << statistics.promotions << ", dominion queries: " << statistics.queries
+                << ", dominions: " << statistics.dominions << std::endl;
+        }
     }
 
     catch (std::exception& exception) {